@@ -0,0 +1,155 @@
+#include "../inst_queue.h"
+#include <time.h>
+
+#define BENCH_DEFAULT_ROUNDS		10000000
+#define BENCH_REPEATS			5
+
+typedef struct ListNode_t	LIST_NODE;
+typedef struct ListQ_name	ListQ;
+
+/************************************************************************/
+/*	Struct's declaration						*/
+/************************************************************************/
+/* The previous malloc-per-node queue, kept here as the reference to compare against */
+struct ListQ_name {
+	LIST_NODE* head;
+	LIST_NODE* tail;
+	int size;
+	int limit;
+};
+
+struct ListNode_t {
+	command_row_t m_Instr;
+	struct ListNode_t* prev;
+};
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Enqueue into the reference linked list queue, one malloc per command */
+bool ListQ_Enqueue(ListQ *, command_row_t);
+/* Peek the head of the reference linked list queue */
+bool ListQ_Peek(ListQ *, command_row_t *);
+/* Pop the head of the reference linked list queue, one free per command */
+bool ListQ_Pop(ListQ *);
+/* Run the fetch/issue pattern over the reference queue and return the elapsed seconds */
+double bench_listQueue(long, unsigned long *);
+/* Run the fetch/issue pattern over the ring buffer queue and return the elapsed seconds */
+double bench_ringQueue(long, unsigned long *);
+
+int main(int argc, char** argv) {
+	long rounds = BENCH_DEFAULT_ROUNDS;
+	unsigned long checksumList = 0, checksumRing = 0;
+	double bestList = 0, bestRing = 0, elapsed = 0;
+	int i = 0;
+	if (argc == 2) {
+		rounds = strtol(argv[1], NULL, 10);
+	}
+	if ((argc > 2) || (rounds < 1)) {
+		printf("Usage: inst_queue_bench [rounds]\n");
+		return EXIT_FAILURE;
+	}
+	for (i=0; i<BENCH_REPEATS; ++i) { /* Keep the best of a few repeats to filter out the noise */
+		elapsed = bench_listQueue(rounds, &checksumList);
+		bestList = ((i == 0) || (elapsed < bestList)) ? elapsed : bestList;
+		elapsed = bench_ringQueue(rounds, &checksumRing);
+		bestRing = ((i == 0) || (elapsed < bestRing)) ? elapsed : bestRing;
+	}
+	if (checksumList != checksumRing) {
+		printf("[Error] The queues disagree (%lu != %lu)\n", checksumList, checksumRing);
+		return EXIT_FAILURE;
+	}
+	printf("%ld enqueue/peek/pop rounds, best of %d\n", rounds, BENCH_REPEATS);
+	printf("  malloc-per-node queue %10.3f ms %8.2f ns/op\n", bestList * 1e3, bestList * 1e9 / rounds);
+	printf("  ring buffer queue     %10.3f ms %8.2f ns/op\n", bestRing * 1e3, bestRing * 1e9 / rounds);
+	printf("  speedup               %10.2fx\n", (bestRing > 0) ? bestList / bestRing : 0.0);
+	return EXIT_SUCCESS;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Enqueue into the reference linked list queue, one malloc per command */
+bool ListQ_Enqueue(ListQ* pQueue, command_row_t Instr) {
+	if (pQueue->size >= pQueue->limit) {
+		return FAILURE;
+	}
+	LIST_NODE* item = (LIST_NODE*) malloc(sizeof(LIST_NODE));
+	if (!item) {
+		return FAILURE;
+	}
+	item->m_Instr = Instr;
+	item->prev = NULL;
+	if (pQueue->size == 0) {
+		pQueue->head = item;
+	} else {
+		pQueue->tail->prev = item;
+	}
+	pQueue->tail = item;
+	pQueue->size++;
+	return SUCCESS;
+}
+
+/* Peek the head of the reference linked list queue */
+bool ListQ_Peek(ListQ* pQueue, command_row_t* pInstr) {
+	if (pQueue->size == 0) {
+		return FAILURE;
+	}
+	*pInstr = pQueue->head->m_Instr;
+	return SUCCESS;
+}
+
+/* Pop the head of the reference linked list queue, one free per command */
+bool ListQ_Pop(ListQ* pQueue) {
+	if (pQueue->size == 0) {
+		return FAILURE;
+	}
+	LIST_NODE* item = pQueue->head;
+	pQueue->head = item->prev;
+	free(item);
+	pQueue->size--;
+	return SUCCESS;
+}
+
+/* Run the fetch/issue pattern over the reference queue and return the elapsed seconds
+ * Every round fetches one command and issues the head once the queue is half full */
+double bench_listQueue(long a_rounds, unsigned long* a_pChecksum) {
+	ListQ queue = { NULL, NULL, 0, INSTRUCTION_QUEUE_LENGTH };
+	command_row_t cmd = { OPCODE_ADD, REGISTER_F1, REGISTER_F2, REGISTER_F3, 0, (1 << REGISTER_F2) | (1 << REGISTER_F3), 1 << REGISTER_F1 };
+	unsigned long checksum = 0;
+	long i = 0;
+	clock_t start = clock();
+	for (i=0; i<a_rounds; ++i) {
+		cmd.imm = (unsigned short int)(i & 0xFFF);
+		ListQ_Enqueue(&queue, cmd);
+		if ((queue.size > (INSTRUCTION_QUEUE_LENGTH / 2)) && (ListQ_Peek(&queue, &cmd) == SUCCESS)) {
+			checksum += cmd.imm;
+			ListQ_Pop(&queue);
+		}
+	}
+	while (ListQ_Pop(&queue) == SUCCESS);
+	*a_pChecksum = checksum;
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Run the fetch/issue pattern over the ring buffer queue and return the elapsed seconds
+ * Every round fetches one command and issues the head once the queue is half full */
+double bench_ringQueue(long a_rounds, unsigned long* a_pChecksum) {
+	InstQ queue;
+	command_row_t cmd = { OPCODE_ADD, REGISTER_F1, REGISTER_F2, REGISTER_F3, 0, (1 << REGISTER_F2) | (1 << REGISTER_F3), 1 << REGISTER_F1 };
+	unsigned long checksum = 0;
+	long i = 0;
+	clock_t start = clock();
+	InstQ_ConstructQueue(&queue, INSTRUCTION_QUEUE_LENGTH);
+	for (i=0; i<a_rounds; ++i) {
+		cmd.imm = (unsigned short int)(i & 0xFFF);
+		InstQ_Enqueue(&queue, cmd);
+		if ((queue.size > (INSTRUCTION_QUEUE_LENGTH / 2)) && (InstQ_Peek(&queue, &cmd) == SUCCESS)) {
+			checksum += cmd.imm;
+			InstQ_Pop(&queue);
+		}
+	}
+	InstQ_DestructQueue(&queue);
+	*a_pChecksum = checksum;
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
@@ -0,0 +1,294 @@
+#include "../defines.h"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_REPEATS		5
+#define BENCH_DEFAULT_THRESHOLD		15 /* Percent of slowdown from the baseline that fails the run */
+#define BENCH_MAX_WORKLOADS		64
+#define BENCH_MIN_COMPARED_MS		20.0 /* Shorter runs are mostly process startup, They are reported but not compared */
+#define BENCH_NAME_MAX_LENGTH		63
+#define BENCH_OUTPUT_FILES		5 /* memout, regout, traceinst, traceunit and the stats report */
+#define BENCH_PATH_MAX_LENGTH		255
+
+typedef struct stWorkloadRun_name	stWorkloadRun;
+
+/************************************************************************/
+/*	Struct's declaration						*/
+/************************************************************************/
+/* One workload of the corpus, With its measurements and its baseline */
+struct stWorkloadRun_name {
+	char		name[BENCH_NAME_MAX_LENGTH + 1];
+	char		cfgPath[BENCH_PATH_MAX_LENGTH + 1];
+	char		meminPath[BENCH_PATH_MAX_LENGTH + 1];
+	char		memorySize[16]; /* The --memory-size of the run, Empty for the default */
+	uint64_t	cycles; /* Simulated cycles, From the stats report of the run */
+	double		bestMs; /* The fastest of the repeats */
+	long		peakRssKb; /* The largest of the repeats */
+	bool		hasBaseline;
+	uint64_t	baselineCycles;
+	double		baselineMs;
+};
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Read the baseline file into the matching workloads, A missing file is an empty baseline
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool bench_loadBaseline(char *, stWorkloadRun *, int);
+/* Read the corpus file, Every line is '<name> <cfg> <memin> [memory size]', '#' lines are comments
+ * The number of workloads is returned, -1 on failure */
+int bench_loadCorpus(char *, stWorkloadRun *);
+/* Read the simulated cycles from the stats report 'path'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool bench_readCycles(char *, uint64_t *);
+/* Run the simulator once on the workload, Its outputs go to 'outDir', The wall time and the peak RSS are returned
+ * With 'selfCheck' the run also compares its results with the timing free engine and fails on a difference
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool bench_runOnce(char *, stWorkloadRun *, char *, bool, double *, long *);
+/* Write the measurements as the new baseline file
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool bench_writeBaseline(char *, stWorkloadRun *, int);
+
+/* Run every workload of the corpus a few times and compare the fastest run with the baseline */
+int main(int argc, char** argv) {
+	stWorkloadRun* pRuns = NULL;
+	char statsPath[BENCH_PATH_MAX_LENGTH + 16];
+	char* paths[4] = { NULL, NULL, NULL, NULL }; /* sim, corpus, baseline and output directory */
+	long repeats = BENCH_DEFAULT_REPEATS, threshold = BENCH_DEFAULT_THRESHOLD, rssKb = 0;
+	double elapsedMs = 0, change = 0;
+	int i = 0, r = 0, pathsNum = 0, runsNum = 0, slowNum = 0;
+	bool isValid = true, update = false, result = SUCCESS;
+	for (i=1; isValid && (i<argc); ++i) {
+		if ((strcmp(argv[i], "--repeats") == 0) && (i + 1 < argc)) {
+			repeats = strtol(argv[++i], NULL, 10);
+			isValid = (1 <= repeats);
+		} else if ((strcmp(argv[i], "--threshold") == 0) && (i + 1 < argc)) {
+			threshold = strtol(argv[++i], NULL, 10);
+			isValid = (0 <= threshold);
+		} else if (strcmp(argv[i], "--update") == 0) {
+			update = true;
+		} else if (pathsNum < 4) {
+			paths[pathsNum++] = argv[i];
+		} else {
+			isValid = false;
+		}
+	}
+	if (!isValid || (pathsNum != 4)) {
+		printf("Usage: sim_bench [--repeats N] [--threshold PERCENT] [--update] <sim> <corpus> <baseline> <output dir>\n");
+		printf("Time the simulator on every workload of the corpus and fail if one is slower than its baseline by more\n");
+		printf("than the threshold (default %d%%), --update writes the measurements as the new baseline.\n", BENCH_DEFAULT_THRESHOLD);
+		printf("Every workload first runs once with --self-check, A difference from the timing free engine fails the run.\n");
+		return EXIT_FAILURE;
+	}
+	pRuns = calloc(BENCH_MAX_WORKLOADS, sizeof(stWorkloadRun));
+	if (pRuns == NULL) {
+		printf("[Fatal] malloc failed\n");
+		return EXIT_FAILURE;
+	}
+	runsNum = bench_loadCorpus(paths[1], pRuns);
+	if ((runsNum < 0) || (!update && (bench_loadBaseline(paths[2], pRuns, runsNum) == FAILURE))) {
+		free(pRuns);
+		return EXIT_FAILURE;
+	}
+	snprintf(statsPath, sizeof(statsPath), "%s/stats.json", paths[3]);
+	printf("%-16s %12s %10s %12s %10s %10s %8s\n", "workload", "cycles", "host ms", "cycles/s", "peak RSS", "base ms", "change");
+	for (i=0; (result == SUCCESS) && (i<runsNum); ++i) {
+		if (bench_runOnce(paths[0], &pRuns[i], paths[3], true, &elapsedMs, &rssKb) == FAILURE) { /* A wrong simulation is not worth timing */
+			printf("[Error] The workload '%s' failed its self check\n", pRuns[i].name);
+			result = FAILURE;
+			break;
+		}
+		for (r=0; r<repeats; ++r) { /* Keep the best of a few repeats to filter out the noise */
+			if (bench_runOnce(paths[0], &pRuns[i], paths[3], false, &elapsedMs, &rssKb) == FAILURE) {
+				result = FAILURE;
+				break;
+			}
+			pRuns[i].bestMs = ((r == 0) || (elapsedMs < pRuns[i].bestMs)) ? elapsedMs : pRuns[i].bestMs;
+			pRuns[i].peakRssKb = (pRuns[i].peakRssKb < rssKb) ? rssKb : pRuns[i].peakRssKb;
+		}
+		if ((result == FAILURE) || (bench_readCycles(statsPath, &pRuns[i].cycles) == FAILURE)) {
+			printf("[Error] The workload '%s' failed\n", pRuns[i].name);
+			result = FAILURE;
+			break;
+		}
+		printf("%-16s %12llu %10.2f %12.4g %7ld KB", pRuns[i].name, (unsigned long long)pRuns[i].cycles, pRuns[i].bestMs,
+			(pRuns[i].bestMs > 0) ? pRuns[i].cycles * 1e3 / pRuns[i].bestMs : 0.0, pRuns[i].peakRssKb);
+		if (update || !pRuns[i].hasBaseline) {
+			printf(" %10s %8s\n", "-", update ? "" : "new");
+			continue;
+		}
+		change = (pRuns[i].bestMs - pRuns[i].baselineMs) * 100 / pRuns[i].baselineMs;
+		printf(" %10.2f %+7.1f%%", pRuns[i].baselineMs, change);
+		if (pRuns[i].cycles != pRuns[i].baselineCycles) {
+			printf(" cycles changed from %llu, Update the baseline\n", (unsigned long long)pRuns[i].baselineCycles);
+			slowNum++;
+		} else if (pRuns[i].baselineMs < BENCH_MIN_COMPARED_MS) {
+			printf(" (too short to compare)\n");
+		} else if (threshold < change) {
+			printf(" SLOWER\n");
+			slowNum++;
+		} else {
+			printf("\n");
+		}
+	}
+	if ((result == SUCCESS) && update) {
+		result = bench_writeBaseline(paths[2], pRuns, runsNum);
+		printf("%s the baseline %s\n", (result == SUCCESS) ? "Updated" : "[Error] Failed to update", paths[2]);
+	} else if ((result == SUCCESS) && (slowNum != 0)) {
+		printf("[Error] %d workload(s) regressed beyond the %ld%% threshold\n", slowNum, threshold);
+		result = FAILURE;
+	}
+	free(pRuns);
+	return (result == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Read the baseline file into the matching workloads, A missing file is an empty baseline
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool bench_loadBaseline(char* path, stWorkloadRun* pRuns, int runsNum) {
+	char line[CONFIGURATION_STR_MAX_LENGTH + 1];
+	char name[BENCH_NAME_MAX_LENGTH + 1];
+	unsigned long long cycles = 0;
+	double ms = 0;
+	int i = 0;
+	FILE* fp = fopen(path, "r");
+	if (fp == NULL) {
+		printf("No baseline at %s, Run 'make bench-baseline' to record one\n", path);
+		return SUCCESS;
+	}
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if ((line[0] == '#') || (sscanf(line, "%63s %llu %lf", name, &cycles, &ms) != 3)) {
+			continue;
+		}
+		for (i=0; i<runsNum; ++i) {
+			if ((strcmp(pRuns[i].name, name) == 0) && (0 < ms)) {
+				pRuns[i].hasBaseline = true;
+				pRuns[i].baselineCycles = cycles;
+				pRuns[i].baselineMs = ms;
+			}
+		}
+	}
+	fclose(fp);
+	return SUCCESS;
+}
+
+/* Read the corpus file, Every line is '<name> <cfg> <memin> [memory size]', '#' lines are comments
+ * The number of workloads is returned, -1 on failure */
+int bench_loadCorpus(char* path, stWorkloadRun* pRuns) {
+	char line[CONFIGURATION_STR_MAX_LENGTH * 3];
+	int runsNum = 0, fields = 0;
+	FILE* fp = fopen(path, "r");
+	if (fp == NULL) {
+		printf("[Error] Can not open the corpus %s\n", path);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (line[0] == '#') {
+			continue;
+		}
+		if (runsNum == BENCH_MAX_WORKLOADS) {
+			printf("[Error] The corpus has more than %d workloads\n", BENCH_MAX_WORKLOADS);
+			fclose(fp);
+			return -1;
+		}
+		fields = sscanf(line, "%63s %255s %255s %15s", pRuns[runsNum].name, pRuns[runsNum].cfgPath, pRuns[runsNum].meminPath,
+			pRuns[runsNum].memorySize);
+		if (fields <= 0) { /* An empty line */
+			continue;
+		}
+		if (fields < 3) {
+			printf("[Error] Invalid corpus line '%s'\n", pRuns[runsNum].name);
+			fclose(fp);
+			return -1;
+		}
+		runsNum++;
+	}
+	fclose(fp);
+	return runsNum;
+}
+
+/* Read the simulated cycles from the stats report 'path'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool bench_readCycles(char* path, uint64_t* pCycles) {
+	char line[OUTPUT_LINE_MAX_LENGTH];
+	unsigned long long cycles = 0;
+	bool isFound = false;
+	FILE* fp = fopen(path, "r");
+	if (fp == NULL) {
+		return FAILURE;
+	}
+	while (!isFound && (fgets(line, sizeof(line), fp) != NULL)) {
+		isFound = (sscanf(line, " \"cycles\": %llu", &cycles) == 1);
+	}
+	fclose(fp);
+	*pCycles = cycles;
+	return isFound ? SUCCESS : FAILURE;
+}
+
+/* Run the simulator once on the workload, Its outputs go to 'outDir', The wall time and the peak RSS are returned
+ * With 'selfCheck' the run also compares its results with the timing free engine and fails on a difference
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool bench_runOnce(char* simPath, stWorkloadRun* pRun, char* outDir, bool selfCheck, double* pElapsedMs, long* pRssKb) {
+	char outPaths[BENCH_OUTPUT_FILES][BENCH_PATH_MAX_LENGTH + 16];
+	const char* outNames[BENCH_OUTPUT_FILES] = { "memout.txt", "regout.txt", "traceinst.txt", "traceunit.txt", "stats.json" };
+	char* args[16];
+	struct timespec start, end;
+	struct rusage usage;
+	int argsNum = 0, status = 0, i = 0;
+	pid_t pid = 0;
+	for (i=0; i<BENCH_OUTPUT_FILES; ++i) {
+		snprintf(outPaths[i], sizeof(outPaths[i]), "%s/%s", outDir, outNames[i]);
+	}
+	args[argsNum++] = simPath;
+	if (pRun->memorySize[0] != '\0') {
+		args[argsNum++] = "--memory-size";
+		args[argsNum++] = pRun->memorySize;
+	}
+	if (selfCheck) {
+		args[argsNum++] = "--self-check";
+	}
+	args[argsNum++] = "--stats";
+	args[argsNum++] = outPaths[4];
+	args[argsNum++] = pRun->cfgPath;
+	args[argsNum++] = pRun->meminPath;
+	for (i=0; i<4; ++i) {
+		args[argsNum++] = outPaths[i];
+	}
+	args[argsNum] = NULL;
+	fflush(stdout); /* The child must not write the buffered table again */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pid = fork();
+	if (pid == 0) {
+		if (freopen("/dev/null", "w", stdout) == NULL) { /* Keep the table readable */
+			_exit(EXIT_FAILURE);
+		}
+		execv(simPath, args);
+		_exit(EXIT_FAILURE);
+	}
+	if ((pid < 0) || (wait4(pid, &status, 0, &usage) != pid)) {
+		printf("[Error] Running %s failed\n", simPath);
+		return FAILURE;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	*pElapsedMs = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+	*pRssKb = usage.ru_maxrss;
+	return (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS)) ? SUCCESS : FAILURE;
+}
+
+/* Write the measurements as the new baseline file
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool bench_writeBaseline(char* path, stWorkloadRun* pRuns, int runsNum) {
+	int i = 0;
+	FILE* fp = fopen(path, "w");
+	if (fp == NULL) {
+		return FAILURE;
+	}
+	fprintf(fp, "# Written by 'make bench-baseline', <workload> <simulated cycles> <best host ms>\n");
+	for (i=0; i<runsNum; ++i) {
+		fprintf(fp, "%s %llu %.3f\n", pRuns[i].name, (unsigned long long)pRuns[i].cycles, pRuns[i].bestMs);
+	}
+	return (fclose(fp) == 0) ? SUCCESS : FAILURE;
+}
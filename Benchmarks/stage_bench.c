@@ -0,0 +1,302 @@
+#include "../scoreboard.c" /* The stage functions are private to scoreboard.c, So it is built into the harness */
+#include <time.h>
+
+#define NUM_OF_BENCH_STAGES		6
+#define STAGE_BENCH_BATCH		256 /* Calls timed together for the stages that do not change the state */
+#define STAGE_BENCH_CYCLE		100 /* The current cycle of the synthetic state */
+#define STAGE_BENCH_DEFAULT_SAMPLES	201
+#define STAGE_BENCH_DEFAULT_WARMUP	20
+#define STAGE_BENCH_DELAY		4
+#define STAGE_BENCH_PRESSURES		{ 0, 4, 8, 16 } /* Registers with a pending result */
+#define STAGE_BENCH_STAGE_NAMES		{ "issue", "readOperands", "execution", "writeResults", "getAvailableFU", "parse_opcode" }
+#define STAGE_BENCH_UNITS		{ 1, 4, 16, 64, 256, 1024, 4096 } /* FUs of every type */
+#define STAGE_GET_AVAILABLE_FU_IDX	4
+#define STAGE_ISSUE_IDX			0
+#define STAGE_PARSE_OPCODE_IDX		5
+
+typedef struct stBenchState_name	stBenchState;
+
+/************************************************************************/
+/*	Struct's declaration						*/
+/************************************************************************/
+/* A synthetic scoreboard state and the snapshot it is restored from before every timed call */
+struct stBenchState_name {
+	stScoreboardCPU		cpu;
+	stScoreboardCPU		savedCPU;
+	stFunctionalUnit*	pSavedFUs;
+	uint32_t*		pSavedStatus[4];
+	stMemory		memory;
+	command_row_t*		pProgram;
+	unsigned int		commandsNum;
+	command_row_t		issueCmd; /* Issued by the issue stage */
+	unsigned int		memoryLines[STAGE_BENCH_BATCH]; /* Decoded by parse_opcode() */
+	unsigned int		pressure; /* The registers that really have a pending result */
+};
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Order two samples for qsort() */
+int stagebench_compare(const void *, const void *);
+/* Build the state of 'units' FUs of every type, All of them busy but the last ADD FU, With 'pressure' registers that
+ * wait for a result, The busy FUs take turns between ready to read, waiting for an operand, executing and done
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool stagebench_build(stBenchState *, unsigned int, unsigned int);
+/* Release the state, Also after a failed build */
+void stagebench_destroy(stBenchState *);
+/* Return the timer, The time stamp counter where there is one and nanoseconds otherwise */
+uint64_t stagebench_now();
+/* Restore the state from its snapshot */
+void stagebench_restore(stBenchState *);
+/* Take 'samples' timings of one call of the stage after 'warmup' untimed ones, In timer ticks without the timer
+ * overhead 'overhead' */
+void stagebench_timeStage(stBenchState *, int, unsigned int, unsigned int, uint64_t, double *);
+
+/* Time every stage function in isolation over a sweep of FU counts and register pressures */
+int main(int argc, char** argv) {
+	const char* stageNames[NUM_OF_BENCH_STAGES] = STAGE_BENCH_STAGE_NAMES;
+	const unsigned int unitsSweep[] = STAGE_BENCH_UNITS;
+	const unsigned int pressureSweep[] = STAGE_BENCH_PRESSURES;
+	stBenchState state;
+	struct timespec start, end;
+	double* pSamples = NULL;
+	double ticksPerNs = 1, mean = 0, variance = 0;
+	uint64_t ticks = 0, overhead = 0, t0 = 0;
+	long samples = STAGE_BENCH_DEFAULT_SAMPLES, warmup = STAGE_BENCH_DEFAULT_WARMUP;
+	unsigned int u = 0, p = 0, i = 0;
+	int stage = 0;
+	if (argc == 3) {
+		samples = strtol(argv[1], NULL, 10);
+		warmup = strtol(argv[2], NULL, 10);
+	}
+	if (((argc != 1) && (argc != 3)) || (samples < 1) || (warmup < 0)) {
+		printf("Usage: stage_bench [samples warmup]\n");
+		return EXIT_FAILURE;
+	}
+	pSamples = malloc(samples * sizeof(double));
+	if (pSamples == NULL) {
+		printf("[Fatal] malloc failed\n");
+		return EXIT_FAILURE;
+	}
+	/* Calibrate the timer to nanoseconds and measure its own overhead */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	t0 = stagebench_now();
+	do {
+		clock_gettime(CLOCK_MONOTONIC, &end);
+	} while ((end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec) < 50000000LL);
+	ticksPerNs = (double)(stagebench_now() - t0) / ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec));
+	for (i=0; i<1000; ++i) {
+		t0 = stagebench_now();
+		ticks = stagebench_now() - t0;
+		overhead = ((i == 0) || (ticks < overhead)) ? ticks : overhead;
+	}
+	printf("Nanoseconds per call, %ld samples after %ld warm-up calls, Timer overhead of %.1f ns removed\n", samples, warmup, overhead / ticksPerNs);
+	printf("%-16s %6s %8s %7s %10s %10s %10s %10s\n", "stage", "units", "pressure", "active", "min", "median", "mean", "stddev");
+	for (stage=0; stage<NUM_OF_BENCH_STAGES; ++stage) {
+		for (u=0; u<sizeof(unitsSweep)/sizeof(unitsSweep[0]); ++u) {
+			for (p=0; p<sizeof(pressureSweep)/sizeof(pressureSweep[0]); ++p) {
+				if (stagebench_build(&state, unitsSweep[u], pressureSweep[p]) == FAILURE) {
+					printf("[Error] Building the state of %u units failed\n", unitsSweep[u]);
+					stagebench_destroy(&state);
+					free(pSamples);
+					return EXIT_FAILURE;
+				}
+				stagebench_timeStage(&state, stage, (unsigned int)samples, (unsigned int)warmup, overhead, pSamples);
+				qsort(pSamples, samples, sizeof(double), stagebench_compare);
+				mean = 0;
+				variance = 0;
+				for (i=0; i<(unsigned int)samples; ++i) {
+					mean += pSamples[i] / samples;
+				}
+				for (i=0; i<(unsigned int)samples; ++i) {
+					variance += (pSamples[i] - mean) * (pSamples[i] - mean) / samples;
+				}
+				printf("%-16s %6u %8u %7u %10.1f %10.1f %10.1f %10.1f\n", stageNames[stage], unitsSweep[u], state.pressure,
+					state.cpu.activeFUs, pSamples[0] / ticksPerNs, pSamples[samples / 2] / ticksPerNs, mean / ticksPerNs,
+					sqrt(variance) / ticksPerNs);
+				stagebench_destroy(&state);
+			}
+		}
+	}
+	free(pSamples);
+	return EXIT_SUCCESS;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Order two samples for qsort() */
+int stagebench_compare(const void* pA, const void* pB) {
+	double a = *(const double*)pA, b = *(const double*)pB;
+	return (a < b) ? -1 : (b < a) ? 1 : 0;
+}
+
+/* Build the state of 'units' FUs of every type, All of them busy but the last ADD FU, With 'pressure' registers that
+ * wait for a result, The busy FUs take turns between ready to read, waiting for an operand, executing and done
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool stagebench_build(stBenchState* pState, unsigned int units, unsigned int pressure) {
+	configuration* config = calloc(1, sizeof(configuration));
+	stFunctionalUnit* pFU = NULL;
+	stFunctionalUnit* pProducer = NULL;
+	unsigned int k = 0, i = 0, phase = 0;
+	memset(pState, 0, sizeof(stBenchState));
+	pState->commandsNum = units * NUM_OF_FU_TYPES;
+	pState->pProgram = calloc(pState->commandsNum + 1, sizeof(command_row_t));
+	if ((config == NULL) || (pState->pProgram == NULL) || (Memory_Init(&(pState->memory), MEMORY_SIZE) == FAILURE)) {
+		free(config);
+		return FAILURE;
+	}
+	config->add_nr_units = config->sub_nr_units = config->mul_nr_units = (unsigned short int)units;
+	config->div_nr_units = config->ld_nr_units = config->st_nr_units = (unsigned short int)units;
+	config->add_delay = config->sub_delay = config->mul_delay = STAGE_BENCH_DELAY;
+	config->div_delay = config->ld_delay = config->st_delay = STAGE_BENCH_DELAY;
+	for (k=NUM_OF_REQUIRED_CONFIGURATION_NUMS; k<NUM_OF_CONFIGURATION_NUMS; ++k) { /* Single issue and blocking FUs, As a cfg file without them */
+		(&(config->add_nr_units))[k] = DEFAULT_OPTIONAL_CFG_VALUE;
+	}
+	for (k=0; k<pState->commandsNum; ++k) {
+		pState->pProgram[k].opcode = OPCODE_ADD;
+	}
+	pState->pProgram[pState->commandsNum].opcode = OPCODE_HALT;
+	if (scoreboard_init(&(pState->cpu), config, &(pState->memory), pState->pProgram, (int)pState->commandsNum) == FAILURE) {
+		return FAILURE;
+	}
+	pState->cpu.cycle = STAGE_BENCH_CYCLE;
+	pState->cpu.lastIssuedPC = pState->commandsNum; /* Every FU holds an older command */
+	/* Give every busy FU its stage, The first executing or done FUs produce the registers under pressure */
+	for (k=0; k<pState->cpu.numOfFUs; ++k) {
+		pFU = &(pState->cpu.pFUs[k]);
+		if (k == pState->cpu.FUsOffset[OPCODE_ADD] + units - 1) { /* Left free for the issue */
+			continue;
+		}
+		phase = k % 4;
+		pFU->Busy = true;
+		pFU->relatedPC = (int)k;
+		pFU->Fi = int_to_reg((int)(k % NUM_OF_REGISTERS));
+		pFU->Fj = int_to_reg((int)((k + 1) % NUM_OF_REGISTERS));
+		pFU->Fk = int_to_reg((int)((k + 2) % NUM_OF_REGISTERS));
+		pFU->Rj = pFU->Rk = (phase <= 1);
+		pFU->time_left = (phase <= 1) ? STAGE_BENCH_DELAY : (phase == 2) ? 2 : 0;
+		pState->cpu.instructionStatus[ISSUE_STAGE_IDX][k] = STAGE_BENCH_CYCLE - 6;
+		pState->cpu.instructionStatus[READ_REGISTERS_STAGE_IDX][k] = (phase <= 1) ? 0 : STAGE_BENCH_CYCLE - 5;
+		pState->cpu.instructionStatus[EXECUTE_END_STAGE_IDX][k] = (phase == 3) ? STAGE_BENCH_CYCLE - 1 : 0;
+		if ((phase >= 2) && (pState->pressure < pressure)) {
+			pFU->Fi = int_to_reg((int)pState->pressure);
+			pState->cpu.registerResultStatus[pState->pressure++] = pFU;
+		}
+		scoreboard_setFUFree(&(pState->cpu), pFU, false);
+		scoreboard_activateFU(&(pState->cpu), pFU);
+	}
+	for (k=0; (pState->pressure != 0) && (k<pState->cpu.numOfFUs); ++k) { /* Link the FUs that wait for an operand */
+		pFU = &(pState->cpu.pFUs[k]);
+		if (!pFU->Busy || (k % 4 != 1)) {
+			continue;
+		}
+		pProducer = pState->cpu.registerResultStatus[k % pState->pressure];
+		pFU->Fj = int_to_reg((int)(k % pState->pressure));
+		pFU->Fi = (pFU->Fi == pFU->Fj) ? int_to_reg((int)((k + 3) % NUM_OF_REGISTERS)) : pFU->Fi;
+		pFU->Qj = pProducer;
+		pFU->Rj = false;
+		pFU->pNextWaitingJ = pProducer->pWaitingJ;
+		pProducer->pWaitingJ = pFU;
+	}
+	/* The issued command waits on its destination once every register is under pressure */
+	pState->issueCmd.opcode = OPCODE_ADD;
+	pState->issueCmd.dst = int_to_reg((int)(pState->pressure % NUM_OF_REGISTERS));
+	pState->issueCmd.src0 = REGISTER_F1;
+	pState->issueCmd.src1 = REGISTER_F2;
+	pState->issueCmd.srcMask = (uint16_t)((1 << REGISTER_F1) | (1 << REGISTER_F2));
+	pState->issueCmd.dstMask = (uint16_t)(1 << pState->issueCmd.dst);
+	for (i=0; i<STAGE_BENCH_BATCH; ++i) {
+		pState->memoryLines[i] = ((i % (OPCODE_HALT + 1)) << 24) | ((i % NUM_OF_REGISTERS) << 20) | ((i * 7 % NUM_OF_REGISTERS) << 16) | (i * 13);
+	}
+	/* Keep the snapshot every timed call starts from */
+	pState->savedCPU = pState->cpu;
+	pState->pSavedFUs = malloc(pState->cpu.numOfFUs * sizeof(stFunctionalUnit));
+	if (pState->pSavedFUs == NULL) {
+		return FAILURE;
+	}
+	memcpy(pState->pSavedFUs, pState->cpu.pFUs, pState->cpu.numOfFUs * sizeof(stFunctionalUnit));
+	for (i=0; i<4; ++i) {
+		pState->pSavedStatus[i] = malloc((pState->commandsNum + 1) * sizeof(uint32_t));
+		if (pState->pSavedStatus[i] == NULL) {
+			return FAILURE;
+		}
+		memcpy(pState->pSavedStatus[i], pState->cpu.instructionStatus[i], (pState->commandsNum + 1) * sizeof(uint32_t));
+	}
+	return SUCCESS;
+}
+
+/* Release the state, Also after a failed build */
+void stagebench_destroy(stBenchState* pState) {
+	int i = 0;
+	scoreboard_destroy(&(pState->cpu), pState->cpu.pConfiguration);
+	free(pState->pSavedFUs);
+	for (i=0; i<4; ++i) {
+		free(pState->pSavedStatus[i]);
+	}
+	free(pState->pProgram);
+	Memory_Destroy(&(pState->memory));
+}
+
+/* Return the timer, The time stamp counter where there is one and nanoseconds otherwise */
+uint64_t stagebench_now() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/* Restore the state from its snapshot */
+void stagebench_restore(stBenchState* pState) {
+	int i = 0;
+	pState->cpu = pState->savedCPU;
+	memcpy(pState->cpu.pFUs, pState->pSavedFUs, pState->cpu.numOfFUs * sizeof(stFunctionalUnit));
+	for (i=0; i<4; ++i) {
+		memcpy(pState->cpu.instructionStatus[i], pState->pSavedStatus[i], (pState->commandsNum + 1) * sizeof(uint32_t));
+	}
+}
+
+/* Take 'samples' timings of one call of the stage after 'warmup' untimed ones, In timer ticks without the timer
+ * overhead 'overhead' */
+void stagebench_timeStage(stBenchState* pState, int stage, unsigned int samples, unsigned int warmup, uint64_t overhead, double* pSamples) {
+	command_row_t cmd;
+	uint64_t t0 = 0, ticks = 0;
+	unsigned int i = 0, j = 0;
+	volatile unsigned int sink = 0;
+	for (i=0; i<warmup+samples; ++i) {
+		if ((stage != STAGE_GET_AVAILABLE_FU_IDX) && (stage != STAGE_PARSE_OPCODE_IDX)) {
+			stagebench_restore(pState);
+		}
+		t0 = stagebench_now();
+		switch (stage) {
+			case STAGE_ISSUE_IDX: sink += scoreboard_issue(&(pState->cpu), pState->issueCmd);
+				break;
+			case 1: scoreboard_readOperands(&(pState->cpu));
+				break;
+			case 2: scoreboard_execution(&(pState->cpu));
+				break;
+			case 3: scoreboard_writeResults(&(pState->cpu));
+				break;
+			case STAGE_GET_AVAILABLE_FU_IDX:
+				for (j=0; j<STAGE_BENCH_BATCH; ++j) {
+					sink += (scoreboard_getAvailableFU(&(pState->cpu), (opcode_t)(j % NUM_OF_FU_TYPES)) != NULL);
+				}
+				break;
+			default:
+				for (j=0; j<STAGE_BENCH_BATCH; ++j) {
+					sink += parse_opcode(pState->memoryLines[j], &cmd);
+				}
+				break;
+		}
+		ticks = stagebench_now() - t0;
+		ticks = (ticks < overhead) ? 0 : (ticks - overhead);
+		if (warmup <= i) {
+			pSamples[i - warmup] = ((stage == STAGE_GET_AVAILABLE_FU_IDX) || (stage == STAGE_PARSE_OPCODE_IDX)) ?
+				(double)ticks / STAGE_BENCH_BATCH : (double)ticks;
+		}
+	}
+	(void)sink;
+}
@@ -0,0 +1,30 @@
+#include "../input_output.h"
+
+/* Regenerate the full memout file from the memin file of the run and a memout written by 'sim --sparse-memout' */
+int main(int argc, char** argv) {
+	stOutBuffer out;
+	stMemory memory;
+	uint32_t memorySize = MEMORY_SIZE;
+	int argsIdx = 1;
+	bool result = FAILURE;
+	if ((argc == 6) && (strcmp(argv[1], "--memory-size") == 0)) {
+		if (parse_memory_size(argv[2], &memorySize) == FAILURE) {
+			return EXIT_FAILURE;
+		}
+		argsIdx = 3;
+	}
+	if (argc - argsIdx != 3) {
+		printf("Usage: memexpand [--memory-size <words>] <memin> <sparse memout> <memout>\n");
+		printf("Expand a sparse memout file back to the full memory image written by the simulator.\n");
+		return EXIT_FAILURE;
+	}
+	if (Memory_Init(&memory, memorySize) == FAILURE) {
+		return EXIT_FAILURE;
+	}
+	if ((load_memin(argv[argsIdx], &memory) == SUCCESS) && (load_sparse_memout(argv[argsIdx + 1], &memory) == SUCCESS) &&
+	    (open_output_file("memout", argv[argsIdx + 2], &out) == SUCCESS)) {
+		result = write_memout(&out, &memory, NULL);
+	}
+	Memory_Destroy(&memory);
+	return (result == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,11 @@
+#include "../trace.h"
+
+/* Regenerate the text traceunit or traceinst file from a trace written by 'sim --binary-trace' */
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		printf("Usage: trace2text <binary trace> <text trace>\n");
+		printf("Convert a binary traceunit or traceinst file back to the text format of the simulator.\n");
+		return EXIT_FAILURE;
+	}
+	return (Trace_ConvertToText(argv[1], argv[2]) == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,285 @@
+#include "../input_output.h"
+#include "../out_buffer.h"
+
+#define WORKGEN_DATA_WORDS		256 /* The words the loads and stores address, Below MEMORY_SIZE so every immediate fits */
+#define WORKGEN_DEFAULT_LENGTH		1000
+#define WORKGEN_DEFAULT_MIX		{ 2, 1, 3, 2, 1, 1 } /* Weights of LD, ST, ADD, SUB, MUL and DIV */
+#define WORKGEN_DEFAULT_UNITS		2
+#define WORKGEN_DELAYS			{ 4, 4, 2, 3, 8, 16 } /* Of LD, ST, ADD, SUB, MUL and DIV */
+#define WORKGEN_HAZARD_WINDOW		4 /* How many commands back a WAR or WAW hazard reaches */
+
+typedef struct stWorkload_name	stWorkload;
+
+/************************************************************************/
+/*	Struct's declaration						*/
+/************************************************************************/
+/* The knobs of one generated workload */
+struct stWorkload_name {
+	uint32_t	seed;
+	uint32_t	length; /* Commands before the HALT */
+	uint32_t	memorySize;
+	uint32_t	mix[NUM_OF_FU_TYPES]; /* Weight of every opcode, Indexed by opcode */
+	uint32_t	chainDepth; /* Commands in every RAW dependency chain, 1 for independent commands */
+	uint32_t	warPercent; /* Chance of a destination that a recent command still reads */
+	uint32_t	wawPercent; /* Chance of a destination that a recent command writes */
+	uint32_t	units; /* FUs of every type */
+};
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Generate the program and its data into 'pMemory' */
+void workgen_generate(const stWorkload *, stMemory *);
+/* Parse the comma separated weights of the six opcodes
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool workgen_parseMix(const char *, uint32_t []);
+/* Parse a decimal number that is not larger than 'max'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool workgen_parseNumber(const char *, uint32_t, uint32_t *);
+/* Return a random register of the mask, Any register if the mask is empty */
+reg_t workgen_pickRegister(uint32_t *, uint16_t);
+/* Return the next number of the xorshift generator */
+uint32_t workgen_random(uint32_t *);
+/* Write the cfg file 'path' of the workload
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool workgen_writeCfg(char *, const stWorkload *);
+
+/* Generate a synthetic memin and a matching cfg, The same options and seed always give the same files */
+int main(int argc, char** argv) {
+	stWorkload workload = { 1, WORKGEN_DEFAULT_LENGTH, MEMORY_SIZE, WORKGEN_DEFAULT_MIX, 1, 0, 0, WORKGEN_DEFAULT_UNITS };
+	stOutBuffer out;
+	stMemory memory;
+	char* paths[2] = { NULL, NULL };
+	int i = 0, pathsNum = 0;
+	bool isValid = true;
+	for (i=1; isValid && (i<argc); ++i) {
+		if ((strncmp(argv[i], "--", 2) == 0) && (i + 1 == argc)) { /* Every option takes a value */
+			isValid = false;
+		} else if (strcmp(argv[i], "--seed") == 0) {
+			isValid = workgen_parseNumber(argv[++i], UINT32_MAX, &workload.seed);
+		} else if (strcmp(argv[i], "--length") == 0) {
+			isValid = workgen_parseNumber(argv[++i], MAX_MEMORY_SIZE, &workload.length);
+		} else if (strcmp(argv[i], "--memory-size") == 0) {
+			isValid = parse_memory_size(argv[++i], &workload.memorySize);
+		} else if (strcmp(argv[i], "--mix") == 0) {
+			isValid = workgen_parseMix(argv[++i], workload.mix);
+		} else if (strcmp(argv[i], "--chain-depth") == 0) {
+			isValid = workgen_parseNumber(argv[++i], MAX_MEMORY_SIZE, &workload.chainDepth) && (workload.chainDepth != 0);
+		} else if (strcmp(argv[i], "--war") == 0) {
+			isValid = workgen_parseNumber(argv[++i], 100, &workload.warPercent);
+		} else if (strcmp(argv[i], "--waw") == 0) {
+			isValid = workgen_parseNumber(argv[++i], 100, &workload.wawPercent);
+		} else if (strcmp(argv[i], "--units") == 0) {
+			isValid = workgen_parseNumber(argv[++i], CONFIGURATION_INT_MAX_VALUE, &workload.units) && (workload.units != 0);
+		} else if (pathsNum < 2) {
+			paths[pathsNum++] = argv[i];
+		} else {
+			isValid = false;
+		}
+	}
+	if (!isValid || (pathsNum != 2) || (100 < workload.warPercent + workload.wawPercent)) {
+		printf("Usage: workgen [options] <memin> <cfg>\n");
+		printf("Generate a synthetic program and a matching configuration for the simulator.\n\n");
+		printf("  --seed N             Seed of the generator (default 1), The same options and seed give the same files.\n");
+		printf("  --length N           Commands before the HALT (default %u), Up to the memory size minus one.\n", WORKGEN_DEFAULT_LENGTH);
+		printf("  --memory-size N      Memory size in words (default %u), Pass the same size to the simulator.\n", MEMORY_SIZE);
+		printf("  --mix LD,ST,ADD,SUB,MUL,DIV\n");
+		printf("                       Weights of the commands (default 2,1,3,2,1,1), The LD and ST weights set the\n");
+		printf("                       store/load ratio.\n");
+		printf("  --chain-depth N      Commands in every RAW dependency chain, Each one reads the result of the one before\n");
+		printf("                       it (default 1, independent commands).\n");
+		printf("  --war P              Percent of destinations that a recent command still reads (default 0).\n");
+		printf("  --waw P              Percent of destinations that a recent command writes (default 0), WAR + WAW <= 100.\n");
+		printf("  --units N            FUs of every type in the cfg (default %u).\n", WORKGEN_DEFAULT_UNITS);
+		return EXIT_FAILURE;
+	}
+	if (workload.memorySize <= workload.length) {
+		printf("[Error] %u commands and the HALT do not fit in %u words, Raise --memory-size\n", workload.length, workload.memorySize);
+		return EXIT_FAILURE;
+	}
+	if ((workload.mix[OPCODE_LD] | workload.mix[OPCODE_ST] | workload.mix[OPCODE_ADD] | workload.mix[OPCODE_SUB] |
+	     workload.mix[OPCODE_MULT] | workload.mix[OPCODE_DIV]) == 0) {
+		printf("[Error] All the weights of the mix are zero\n");
+		return EXIT_FAILURE;
+	}
+	if (Memory_Init(&memory, workload.memorySize) == FAILURE) {
+		return EXIT_FAILURE;
+	}
+	workgen_generate(&workload, &memory);
+	isValid = !memory.failed && (open_output_file("memin", paths[0], &out) == SUCCESS) && (write_memout(&out, &memory, NULL) == SUCCESS) &&
+		(workgen_writeCfg(paths[1], &workload) == SUCCESS);
+	Memory_Destroy(&memory);
+	if (!isValid) {
+		printf("[Error] Writing the workload failed\n");
+		return EXIT_FAILURE;
+	}
+	if (MEMORY_SIZE < workload.memorySize) {
+		printf("Run the simulator with '--memory-size %u'\n", workload.memorySize);
+	}
+	return EXIT_SUCCESS;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Generate the program and its data into 'pMemory' */
+void workgen_generate(const stWorkload* pWorkload, stMemory* pMemory) {
+	uint16_t recentReads[WORKGEN_HAZARD_WINDOW] = {0}; /* Registers read by the last commands */
+	uint16_t recentWrites[WORKGEN_HAZARD_WINDOW] = {0}; /* Registers written by the last commands */
+	uint16_t readMask = 0, writeMask = 0, freeMask = 0;
+	uint32_t seed = (pWorkload->seed != 0) ? pWorkload->seed : 1; /* xorshift never leaves zero */
+	uint32_t mixTotal = 0, dataBase = 0, i = 0, roll = 0, chainPos = 0, word = 0;
+	int opcode = 0, prevDst = -1, j = 0;
+	float value = 0;
+	command_row_t cmd;
+	for (opcode=0; opcode<NUM_OF_FU_TYPES; ++opcode) {
+		mixTotal += pWorkload->mix[opcode];
+	}
+	if (pWorkload->length + 1 + WORKGEN_DATA_WORDS <= MEMORY_SIZE) { /* The data follows the HALT */
+		dataBase = pWorkload->length + 1;
+		for (i=0; i<WORKGEN_DATA_WORDS; ++i) {
+			value = 1.0f + (float)(i % 8) * 0.5f;
+			memcpy(&word, &value, sizeof(word)); /* The IEEE 754 bits of the value */
+			Memory_Write(pMemory, dataBase + i, word);
+		}
+	} else { /* The data overlaps the program text, The simulator decodes the program before the run so stores there do not change it */
+		dataBase = MEMORY_SIZE - WORKGEN_DATA_WORDS;
+	}
+	for (i=0; i<pWorkload->length; ++i) {
+		readMask = 0;
+		writeMask = 0;
+		for (j=0; j<WORKGEN_HAZARD_WINDOW; ++j) {
+			readMask |= recentReads[j];
+			writeMask |= recentWrites[j];
+		}
+		memset(&cmd, 0, sizeof(cmd));
+		roll = workgen_random(&seed) % mixTotal;
+		for (opcode=0; pWorkload->mix[opcode] <= roll; ++opcode) {
+			roll -= pWorkload->mix[opcode];
+		}
+		cmd.opcode = (opcode_t)opcode;
+		/* The sources, The first one continues the dependency chain, The rest avoid the results still in flight */
+		cmd.src0 = workgen_pickRegister(&seed, (uint16_t)~writeMask);
+		cmd.src1 = workgen_pickRegister(&seed, (uint16_t)~writeMask);
+		if ((chainPos != 0) && (0 <= prevDst)) {
+			if (cmd.opcode == OPCODE_ST) {
+				cmd.src1 = int_to_reg(prevDst);
+			} else {
+				cmd.src0 = int_to_reg(prevDst);
+			}
+		}
+		cmd.srcMask = (cmd.opcode == OPCODE_LD) ? 0 : (cmd.opcode == OPCODE_ST) ? (uint16_t)(1 << cmd.src1) :
+			(uint16_t)((1 << cmd.src0) | (1 << cmd.src1));
+		if ((cmd.opcode == OPCODE_LD) || (cmd.opcode == OPCODE_ST)) {
+			cmd.imm = (unsigned short int)(dataBase + workgen_random(&seed) % WORKGEN_DATA_WORDS);
+		}
+		/* The destination, A WAR or a WAW hazard with a recent command, Otherwise a register no recent command uses */
+		roll = workgen_random(&seed) % 100;
+		freeMask = (uint16_t)~(readMask | writeMask | cmd.srcMask);
+		if ((roll < pWorkload->warPercent) && (readMask != 0)) {
+			cmd.dst = workgen_pickRegister(&seed, readMask);
+		} else if ((roll < pWorkload->warPercent + pWorkload->wawPercent) && (writeMask != 0)) {
+			cmd.dst = workgen_pickRegister(&seed, writeMask);
+		} else {
+			cmd.dst = workgen_pickRegister(&seed, (freeMask != 0) ? freeMask : (uint16_t)~writeMask);
+		}
+		if (cmd.opcode == OPCODE_ST) {
+			cmd.dst = REGISTER_F0; /* Unused by a store */
+		}
+		cmd.dstMask = (cmd.opcode == OPCODE_ST) ? 0 : (uint16_t)(1 << cmd.dst);
+		Memory_Write(pMemory, i, encode_command(&cmd));
+		recentReads[i % WORKGEN_HAZARD_WINDOW] = cmd.srcMask;
+		recentWrites[i % WORKGEN_HAZARD_WINDOW] = cmd.dstMask;
+		prevDst = (cmd.opcode == OPCODE_ST) ? -1 : (int)cmd.dst;
+		chainPos = (chainPos + 1 == pWorkload->chainDepth) ? 0 : (chainPos + 1);
+	}
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.opcode = OPCODE_HALT;
+	Memory_Write(pMemory, pWorkload->length, encode_command(&cmd));
+}
+
+/* Parse the comma separated weights of the six opcodes
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool workgen_parseMix(const char* str, uint32_t mix[]) {
+	char* pEnd = NULL;
+	unsigned long value = 0;
+	int opcode = 0;
+	for (opcode=0; opcode<NUM_OF_FU_TYPES; ++opcode) {
+		errno = 0;
+		value = strtoul(str, &pEnd, 10);
+		if ((errno != 0) || (pEnd == str) || (*str == '-') || (MAX_MEMORY_SIZE < value)) {
+			return FAILURE;
+		}
+		if (*pEnd != ((opcode + 1 == NUM_OF_FU_TYPES) ? '\0' : ',')) {
+			return FAILURE;
+		}
+		mix[opcode] = (uint32_t)value;
+		str = pEnd + 1;
+	}
+	return SUCCESS;
+}
+
+/* Parse a decimal number that is not larger than 'max'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool workgen_parseNumber(const char* str, uint32_t max, uint32_t* pValue) {
+	char* pEnd = NULL;
+	unsigned long value = 0;
+	errno = 0;
+	value = strtoul(str, &pEnd, 10);
+	if ((errno != 0) || (pEnd == str) || (*pEnd != '\0') || (*str == '-') || (max < value)) {
+		return FAILURE;
+	}
+	*pValue = (uint32_t)value;
+	return SUCCESS;
+}
+
+/* Return a random register of the mask, Any register if the mask is empty */
+reg_t workgen_pickRegister(uint32_t* pSeed, uint16_t mask) {
+	int count = 0, idx = 0, reg = 0;
+	for (reg=0; reg<NUM_OF_REGISTERS; ++reg) {
+		count += (mask >> reg) & 0x1;
+	}
+	if (count == 0) {
+		return int_to_reg((int)(workgen_random(pSeed) % NUM_OF_REGISTERS));
+	}
+	idx = (int)(workgen_random(pSeed) % (uint32_t)count);
+	for (reg=0; ; ++reg) {
+		if (((mask >> reg) & 0x1) && (idx-- == 0)) {
+			return int_to_reg(reg);
+		}
+	}
+}
+
+/* Return the next number of the xorshift generator */
+uint32_t workgen_random(uint32_t* pSeed) {
+	uint32_t x = *pSeed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*pSeed = x;
+	return x;
+}
+
+/* Write the cfg file 'path' of the workload
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool workgen_writeCfg(char* path, const stWorkload* pWorkload) {
+	const char* names[NUM_OF_FU_TYPES] = { "ld", "st", "add", "sub", "mul", "div" }; /* Indexed by opcode */
+	const unsigned int delays[NUM_OF_FU_TYPES] = WORKGEN_DELAYS;
+	stOutBuffer out;
+	char* pLine = NULL;
+	int opcode = 0;
+	if (open_output_file("cfg", path, &out) == FAILURE) {
+		return FAILURE;
+	}
+	for (opcode=0; opcode<NUM_OF_FU_TYPES; ++opcode) {
+		pLine = OutBuf_Reserve(&out);
+		OutBuf_Commit(&out, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "%s_nr_units = %u\n", names[opcode], pWorkload->units));
+	}
+	for (opcode=0; opcode<NUM_OF_FU_TYPES; ++opcode) {
+		pLine = OutBuf_Reserve(&out);
+		OutBuf_Commit(&out, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "%s_delay = %u\n", names[opcode], delays[opcode]));
+	}
+	pLine = OutBuf_Reserve(&out);
+	OutBuf_Commit(&out, OutBuf_FormatString(pLine, "trace_unit = ADD0\n"));
+	return OutBuf_Close(&out);
+}
@@ -0,0 +1,451 @@
+#include "batch.h"
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Close the output files of a job that are still open, after a stage failed */
+void batch_closeOutputs(stOutBuffer *);
+/* Copy 'src' into a newly allocated string, return NULL if the malloc failed */
+char* batch_copyString(const char *);
+/* Free the paths of the first 'jobsNum' jobs and the jobs array itself */
+void batch_freeJobs(stSimJob *, unsigned int);
+/* Return the number of online CPUs, or DEFAULT_BATCH_THREADS if it is unknown */
+int batch_getOnlineCPUs();
+/* Parse the manifest file 'path' into a newly allocated jobs array stored at 'pJobs'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool batch_loadManifest(char *, stSimJob **, unsigned int *);
+/* Run the manifest job 'jobIdx', 'pContext' is the jobs array */
+void batch_runManifestJob(void *, unsigned int);
+/* Run the program of the finished timing run 'pCPU' again with the timing free engine on 'pMemory' (a copy of the
+ * initial memory) and compare the registers and the memory of both engines, Every difference is reported
+ * The function return SUCCESS (true) if the results are identical and FAILURE (false) otherwise */
+bool batch_selfCheck(stScoreboardCPU *, stMemory *, command_row_t *, unsigned int);
+/* The body of every worker thread, takes jobs from the pool until none are left */
+void* batch_worker(void *);
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Run every job listed in the manifest file 'path' on a pool of 'threads' workers (0 picks the number of online CPUs)
+ * Every manifest line holds the six paths of one job: <cfg> <memin> <memout> <regout> <traceinst> <traceunit>
+ * All the jobs take their options (binaryTrace, sparseMemout, memorySize, functional, selfCheck, sampling and engine) from 'pOptions'
+ * The function return SUCCESS (true) if all the jobs succeeded and FAILURE (false) otherwise */
+bool batch_runManifest(char* path, int threads, const stSimJob* pOptions) {
+	stSimJob* jobs = NULL;
+	unsigned int jobsNum = 0, failedJobs = 0, i = 0;
+	if (batch_loadManifest(path, &jobs, &jobsNum) == FAILURE) {
+		return FAILURE;
+	}
+	for (i=0; i<jobsNum; ++i) {
+		jobs[i].binaryTrace = pOptions->binaryTrace;
+		jobs[i].sparseMemout = pOptions->sparseMemout;
+		jobs[i].memorySize = pOptions->memorySize;
+		jobs[i].functional = pOptions->functional;
+		jobs[i].selfCheck = pOptions->selfCheck;
+		jobs[i].checkpointPath = NULL; /* Checkpoints are for single runs only */
+		jobs[i].checkpointCycle = 0;
+		jobs[i].restorePath = NULL;
+		jobs[i].samplePeriod = pOptions->samplePeriod;
+		jobs[i].detailWindow = pOptions->detailWindow;
+		jobs[i].statsPath = NULL; /* Every job would need its own report file */
+		jobs[i].probesPath = NULL;
+		jobs[i].engine = pOptions->engine;
+	}
+	batch_runParallel(batch_runManifestJob, jobs, jobsNum, threads);
+	for (i=0; i<jobsNum; ++i) { /* Report in manifest order, regardless of the order the jobs ended */
+		if (jobs[i].error != NULL) {
+			Message_Print("[Error] Job at manifest line %u failed: %s\n", jobs[i].line, jobs[i].error);
+			failedJobs++;
+		} else if (jobs[i].samplePeriod != 0) {
+			printf("Job at manifest line %u: ", jobs[i].line);
+			sample_printResult(&(jobs[i].sample));
+		}
+	}
+	printf("Batch finished, %u of %u jobs succeeded\n", jobsNum - failedJobs, jobsNum);
+	batch_freeJobs(jobs, jobsNum);
+	return (failedJobs == 0) ? SUCCESS : FAILURE;
+}
+
+/* Run 'jobsNum' independent jobs on a pool of 'threads' workers, calling 'pJobFunc(pContext, jobIdx)' once per job */
+void batch_runParallel(void (*pJobFunc)(void *, unsigned int), void* pContext, unsigned int jobsNum, int threads) {
+	stWorkerPool pool;
+	pool.pJobFunc = pJobFunc;
+	pool.pContext = pContext;
+	pool.jobsNum = jobsNum;
+	pool.nextJob = 0;
+	if (threads <= 0) {
+		threads = batch_getOnlineCPUs();
+	}
+	if (MAX_BATCH_THREADS < threads) {
+		threads = MAX_BATCH_THREADS;
+	}
+	if (jobsNum < (unsigned int)threads) {
+		threads = (int)jobsNum;
+	}
+#ifndef _WIN32
+	pthread_t workers[MAX_BATCH_THREADS];
+	int created = 0, i = 0;
+	pthread_mutex_init(&(pool.lock), NULL);
+	for (i=1; i<threads; ++i) { /* The calling thread is the first worker */
+		if (pthread_create(&workers[created], NULL, batch_worker, &pool) == 0) { /* pthread_create() returns 0 on success, Run with fewer workers otherwise */
+			created++;
+		}
+	}
+	batch_worker(&pool);
+	for (i=0; i<created; ++i) {
+		pthread_join(workers[i], NULL);
+	}
+	pthread_mutex_destroy(&(pool.lock));
+#else
+	batch_worker(&pool); /* No thread pool on Windows, run the jobs one after the other */
+#endif /* _WIN32 */
+}
+
+/* Run a single simulation job, all the state lives on the stack of the caller so jobs can run in parallel
+ * The output files are opened once before the simulation and every writer closes its own file
+ * On failure 'error' of the job is set to the stage that failed
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool batch_runJob(stSimJob* pJob) {
+	stScoreboardCPU scoreboardCPU;
+	stOutBuffer outputs[NUM_OF_OUTPUT_FILES];
+	stMemory memory;
+	stMemory initialMemory;
+	stMemory checkMemory;
+	stTraceFile traceUnit;
+	stCheckpoint checkpoint;
+	stStats stats;
+	stProbeSession probeSession;
+	float functionalRegisters[NUM_OF_REGISTERS];
+	command_row_t* program = NULL;
+	unsigned int instructionNum = 0;
+	configuration* config = NULL;
+	bool filesAccessible = true, writesTraces = !pJob->functional && (pJob->samplePeriod == 0);
+	int i = 0;
+	pJob->error = NULL;
+	for (i=0; i<NUM_OF_OUTPUT_FILES; ++i) { /* A NULL buffer marks an output file that is not open */
+		outputs[i].pBuffer = NULL;
+	}
+	memory.pPages = NULL; /* A NULL page table marks a memory that was not initialized */
+	initialMemory.pPages = NULL;
+	checkMemory.pPages = NULL;
+	checkpoint.pData = NULL;
+	/* Check the input files and open the output files, The timing free and the sampled runs write no traces
+	 * A restored run reads its inputs from the checkpoint and resumes its traceunit file */
+	if (pJob->restorePath == NULL) {
+		filesAccessible = (check_files_permission("cfg", pJob->paths[CFG_FILE_IDX], CHECK_INPUT_FILE) == SUCCESS) &
+				  (check_files_permission("memin", pJob->paths[MEMIN_FILE_IDX], CHECK_INPUT_FILE) == SUCCESS);
+	}
+	if (!filesAccessible) {
+		pJob->error = "Checking files permission failed";
+		return FAILURE;
+	}
+	filesAccessible = (open_output_file("memout", pJob->paths[MEMOUT_FILE_IDX], &outputs[MEMOUT_FILE_IDX]) == SUCCESS) &
+			  (open_output_file("regout", pJob->paths[REGOUT_FILE_IDX], &outputs[REGOUT_FILE_IDX]) == SUCCESS);
+	if (writesTraces) {
+		filesAccessible = filesAccessible &
+				  (open_output_file("traceinst", pJob->paths[TRACEINST_FILE_IDX], &outputs[TRACEINST_FILE_IDX]) == SUCCESS);
+	}
+	if (writesTraces && (pJob->restorePath == NULL)) {
+		filesAccessible = filesAccessible &
+				  (open_output_file("traceunit", pJob->paths[TRACEUNIT_FILE_IDX], &outputs[TRACEUNIT_FILE_IDX]) == SUCCESS);
+	}
+	if (pJob->statsPath != NULL) {
+		filesAccessible = filesAccessible & (open_output_file("stats", pJob->statsPath, &outputs[STATS_FILE_IDX]) == SUCCESS);
+	}
+	if (pJob->probesPath != NULL) {
+		filesAccessible = filesAccessible & (open_output_file("probes", pJob->probesPath, &outputs[PROBES_FILE_IDX]) == SUCCESS);
+	}
+	if (!filesAccessible) {
+		pJob->error = "Opening output files failed";
+		batch_closeOutputs(outputs);
+		return FAILURE;
+	}
+	config = (configuration*) malloc(sizeof(configuration));
+	if (!config) {
+		pJob->error = "Configuration malloc failed";
+		batch_closeOutputs(outputs);
+		return FAILURE;
+	}
+	/* Load the inputs */
+	if (pJob->restorePath != NULL) {
+		if (Checkpoint_Open(&checkpoint, pJob->restorePath) == FAILURE) {
+			pJob->error = "Opening checkpoint file failed";
+		} else if (Checkpoint_LoadInputs(&checkpoint, config, &memory, &program, &instructionNum) == FAILURE) {
+			pJob->error = "Restoring checkpoint inputs failed";
+		}
+	} else if (load_cfg(pJob->paths[CFG_FILE_IDX], config) == FAILURE) {
+		pJob->error = "Parsing configuration file failed";
+	} else if (Memory_Init(&memory, pJob->memorySize) == FAILURE) {
+		pJob->error = "Memory initialization failed";
+	} else if (load_memin(pJob->paths[MEMIN_FILE_IDX], &memory) == FAILURE) {
+		pJob->error = "Parsing memin file failed";
+	} else if (decode_program(&memory, &program, &instructionNum) == FAILURE) {
+		pJob->error = "Decoding memin program failed";
+	} else if (pJob->sparseMemout && (Memory_Copy(&initialMemory, &memory) == FAILURE)) { /* The sparse memout holds only the words that differ from memin */
+		pJob->error = "Memory copy failed";
+	} else if (pJob->selfCheck && (Memory_Copy(&checkMemory, &memory) == FAILURE)) { /* The timing free engine runs on its own copy */
+		pJob->error = "Memory copy failed";
+	}
+	if ((pJob->error != NULL) || pJob->functional) {
+		free(config);
+	}
+	if (pJob->error != NULL) {
+		Memory_Destroy(&memory);
+		Memory_Destroy(&initialMemory);
+		Checkpoint_Close(&checkpoint);
+		batch_closeOutputs(outputs);
+		free(program);
+		return FAILURE;
+	}
+	/* Start the program */
+	if (pJob->functional) {
+		if (scoreboard_runFunctional(&memory, program, instructionNum, functionalRegisters) == FAILURE) {
+			pJob->error = "Functional run failed";
+		} else if (write_memout(&outputs[MEMOUT_FILE_IDX], &memory, pJob->sparseMemout ? &initialMemory : NULL) == FAILURE) {
+			pJob->error = "Saving memout file failed";
+		} else if (write_regout(&outputs[REGOUT_FILE_IDX], functionalRegisters) == FAILURE) {
+			pJob->error = "Saving regout file failed";
+		}
+	} else if (pJob->samplePeriod != 0) {
+		if (sample_run(config, &memory, program, instructionNum, pJob->samplePeriod, pJob->detailWindow, pJob->engine, functionalRegisters, &(pJob->sample)) == FAILURE) {
+			pJob->error = "Sampled run failed";
+		} else if (write_memout(&outputs[MEMOUT_FILE_IDX], &memory, pJob->sparseMemout ? &initialMemory : NULL) == FAILURE) {
+			pJob->error = "Saving memout file failed";
+		} else if (write_regout(&outputs[REGOUT_FILE_IDX], functionalRegisters) == FAILURE) {
+			pJob->error = "Saving regout file failed";
+		}
+		free(config);
+	} else {
+		if (scoreboard_init(&scoreboardCPU, config, &memory, program, instructionNum) == FAILURE) {
+			pJob->error = "Scoreboard initialization failed";
+		} else if ((pJob->restorePath != NULL) &&
+			   (Checkpoint_LoadState(&checkpoint, &scoreboardCPU, &traceUnit, &outputs[TRACEUNIT_FILE_IDX], pJob->paths[TRACEUNIT_FILE_IDX]) == FAILURE)) {
+			pJob->error = "Restoring checkpoint state failed";
+		} else if ((pJob->restorePath == NULL) &&
+			   (Trace_Open(&traceUnit, &outputs[TRACEUNIT_FILE_IDX], pJob->binaryTrace, BIN_TRACE_UNIT_MAGIC, scoreboardCPU.FUsNum, scoreboardCPU.FUsDepth) == FAILURE)) {
+			pJob->error = "Opening traceunit file failed";
+		} else {
+			if (pJob->restorePath == NULL) { /* A restored run keeps the engine of the checkpoint */
+				scoreboardCPU.engine = pJob->engine;
+			}
+			scoreboardCPU.pCheckpointPath = pJob->checkpointPath;
+			scoreboardCPU.checkpointCycle = pJob->checkpointCycle;
+			if (pJob->statsPath != NULL) {
+				memset(&stats, 0, sizeof(stats));
+				scoreboardCPU.pStats = &stats;
+			}
+			if ((pJob->probesPath != NULL) && (Probe_StartSession(&probeSession) == FAILURE)) {
+				pJob->error = "Attaching the probes failed";
+			} else {
+				if (pJob->probesPath != NULL) {
+					scoreboardCPU.pProbes = &(probeSession.probes);
+				}
+				if (scoreboard_cycle(&scoreboardCPU, &traceUnit) == FAILURE) {
+					pJob->error = "Scoreboard algorithm cycles failed";
+				}
+				if (pJob->probesPath != NULL) { /* Every event the run fired is counted once the session ends */
+					scoreboardCPU.pProbes = NULL;
+					Probe_EndSession(&probeSession);
+				}
+			}
+			Trace_Close(&traceUnit);
+			if ((OutBuf_Close(&outputs[TRACEUNIT_FILE_IDX]) == FAILURE) && (pJob->error == NULL)) {
+				pJob->error = "Saving traceunit file failed";
+			}
+		}
+		/* Save the output, A restored run keeps the trace format of the checkpoint */
+		if (pJob->error == NULL) {
+			if (write_memout(&outputs[MEMOUT_FILE_IDX], &memory, pJob->sparseMemout ? &initialMemory : NULL) == FAILURE) {
+				pJob->error = "Saving memout file failed";
+			} else if (write_regout(&outputs[REGOUT_FILE_IDX], scoreboardCPU.Register) == FAILURE) {
+				pJob->error = "Saving regout file failed";
+			} else if (write_traceinst(&outputs[TRACEINST_FILE_IDX], &scoreboardCPU, traceUnit.binary) == FAILURE) {
+				pJob->error = "Saving traceinst file failed";
+			} else if ((pJob->statsPath != NULL) && (write_stats(&outputs[STATS_FILE_IDX], &scoreboardCPU) == FAILURE)) {
+				pJob->error = "Saving stats file failed";
+			} else if ((pJob->probesPath != NULL) && (write_probes(&outputs[PROBES_FILE_IDX], &probeSession) == FAILURE)) {
+				pJob->error = "Saving probes file failed";
+			} else if ((pJob->probesPath != NULL) && (Probe_CheckCounts(&probeSession, scoreboardCPU.lastIssuedPC) == FAILURE)) {
+				pJob->error = "Probe event counts do not match the run";
+			} else if (pJob->selfCheck && (batch_selfCheck(&scoreboardCPU, &checkMemory, program, instructionNum) == FAILURE)) {
+				pJob->error = "Self check failed";
+			}
+		}
+		scoreboard_destroy(&scoreboardCPU, config);
+	}
+	/* Cleanup */
+	batch_closeOutputs(outputs);
+	Memory_Destroy(&memory);
+	Memory_Destroy(&initialMemory);
+	Memory_Destroy(&checkMemory);
+	Checkpoint_Close(&checkpoint);
+	free(program);
+	return (pJob->error == NULL) ? SUCCESS : FAILURE;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Close the output files of a job that are still open, after a stage failed */
+void batch_closeOutputs(stOutBuffer* outputs) {
+	int i = 0;
+	for (i=0; i<NUM_OF_OUTPUT_FILES; ++i) {
+		if (outputs[i].pBuffer != NULL) {
+			OutBuf_Close(&outputs[i]);
+		}
+	}
+}
+
+/* Copy 'src' into a newly allocated string, return NULL if the malloc failed */
+char* batch_copyString(const char* src) {
+	char* copy = (char*) malloc(strlen(src) + 1);
+	if (copy) {
+		strcpy(copy, src);
+	}
+	return copy;
+}
+
+/* Free the paths of the first 'jobsNum' jobs and the jobs array itself */
+void batch_freeJobs(stSimJob* jobs, unsigned int jobsNum) {
+	unsigned int i = 0, j = 0;
+	for (i=0; i<jobsNum; ++i) {
+		for (j=0; j<NUM_OF_SIM_FILES; ++j) {
+			free(jobs[i].paths[j]);
+		}
+	}
+	free(jobs);
+}
+
+/* Return the number of online CPUs, or DEFAULT_BATCH_THREADS if it is unknown */
+int batch_getOnlineCPUs() {
+#ifndef _WIN32
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN); /* sysconf() returns -1 if the value is unknown */
+	if (0 < cpus) {
+		return (int)cpus;
+	}
+#endif /* _WIN32 */
+	return DEFAULT_BATCH_THREADS;
+}
+
+/* Parse the manifest file 'path' into a newly allocated jobs array stored at 'pJobs'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool batch_loadManifest(char* path, stSimJob** pJobs, unsigned int* pJobsNum) {
+	FILE* fp;
+	stSimJob* jobs = NULL;
+	stSimJob* grown = NULL;
+	unsigned int jobsNum = 0, capacity = 0, line_count = 0, filesNum = 0;
+	char* line = NULL;
+	char* token = NULL;
+	size_t len = 0;
+	bool isValid = true;
+	fp = fopen(path, "r"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
+	if (fp == NULL) {
+		perror("fopen");
+		return FAILURE;
+	}
+	while (isValid && (getline(&line, &len, fp) != -1)) {
+		line_count++;
+		token = strtok(line, " \t\r\n");
+		if ((token == NULL) || (token[0] == '#')) { /* Skip empty lines and comments */
+			continue;
+		}
+		if (jobsNum == capacity) {
+			capacity = (capacity == 0) ? 64 : (capacity * 2);
+			grown = (stSimJob*) realloc(jobs, sizeof(stSimJob) * capacity);
+			if (!grown) {
+				Message_Print("[Fatal] Manifest parsing malloc failed\n");
+				isValid = false;
+				break;
+			}
+			jobs = grown;
+		}
+		memset(&jobs[jobsNum], 0, sizeof(stSimJob));
+		jobs[jobsNum].line = line_count;
+		for (filesNum=0; (token != NULL) && (filesNum < NUM_OF_SIM_FILES); ++filesNum) {
+			jobs[jobsNum].paths[filesNum] = batch_copyString(token);
+			token = strtok(NULL, " \t\r\n");
+		}
+		jobsNum++; /* Count the job even if it is invalid, so batch_freeJobs() releases its paths */
+		if ((filesNum != NUM_OF_SIM_FILES) || (token != NULL)) {
+			Message_Print("[Error] Manifest line %u must hold exactly %d paths\n", line_count, NUM_OF_SIM_FILES);
+			isValid = false;
+		}
+		for (filesNum=0; isValid && (filesNum < NUM_OF_SIM_FILES); ++filesNum) {
+			if (jobs[jobsNum - 1].paths[filesNum] == NULL) {
+				Message_Print("[Fatal] Manifest parsing malloc failed\n");
+				isValid = false;
+			}
+		}
+	}
+	if (line) {
+		free(line);
+	}
+	fclose(fp);
+	if (isValid && (jobsNum == 0)) {
+		Message_Print("[Error] Manifest file '%s' has no jobs\n", path);
+		isValid = false;
+	}
+	if (!isValid) {
+		batch_freeJobs(jobs, jobsNum);
+		return FAILURE;
+	}
+	*pJobs = jobs;
+	*pJobsNum = jobsNum;
+	return SUCCESS;
+}
+
+/* Run the manifest job 'jobIdx', 'pContext' is the jobs array */
+void batch_runManifestJob(void* pContext, unsigned int jobIdx) {
+	stSimJob* jobs = (stSimJob*) pContext;
+	Message_SetJobLine(jobs[jobIdx].line); /* The errors printed while the job runs name its manifest line */
+	batch_runJob(&jobs[jobIdx]);
+	Message_SetJobLine(0);
+}
+
+/* Run the program of the finished timing run 'pCPU' again with the timing free engine on 'pMemory' (a copy of the
+ * initial memory) and compare the registers and the memory of both engines, Every difference is reported
+ * The function return SUCCESS (true) if the results are identical and FAILURE (false) otherwise */
+bool batch_selfCheck(stScoreboardCPU* pCPU, stMemory* pMemory, command_row_t* program, unsigned int instructionNum) {
+	float registers[NUM_OF_REGISTERS];
+	uint32_t address = 0;
+	bool isEqual = true;
+	int i = 0;
+	if (scoreboard_runFunctional(pMemory, program, instructionNum, registers) == FAILURE) {
+		return FAILURE;
+	}
+	for (i=0; i<NUM_OF_REGISTERS; ++i) { /* Compare the bits, so NaN results compare as well */
+		if (memcmp(&registers[i], &(pCPU->Register[i]), sizeof(float)) != 0) {
+			Message_Print("[Error] Self check, F%d is %f in the timing run and %f in the functional run\n", i, pCPU->Register[i], registers[i]);
+			isEqual = false;
+		}
+	}
+	if (!Memory_IsEqual(pCPU->pMemory, pMemory, &address)) {
+		Message_Print("[Error] Self check, memory word %u is %08x in the timing run and %08x in the functional run\n", address,
+			Memory_Read(pCPU->pMemory, address), Memory_Read(pMemory, address));
+		isEqual = false;
+	}
+	return isEqual ? SUCCESS : FAILURE;
+}
+
+/* The body of every worker thread, takes jobs from the pool until none are left */
+void* batch_worker(void* pArg) {
+	stWorkerPool* pPool = (stWorkerPool*) pArg;
+	unsigned int jobIdx = 0;
+	while (true) {
+#ifndef _WIN32
+		pthread_mutex_lock(&(pPool->lock));
+#endif /* _WIN32 */
+		jobIdx = pPool->nextJob;
+		if (jobIdx < pPool->jobsNum) {
+			pPool->nextJob++;
+		}
+#ifndef _WIN32
+		pthread_mutex_unlock(&(pPool->lock));
+#endif /* _WIN32 */
+		if (pPool->jobsNum <= jobIdx) {
+			break;
+		}
+		pPool->pJobFunc(pPool->pContext, jobIdx);
+	}
+	return NULL;
+}
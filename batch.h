@@ -0,0 +1,25 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include "defines.h"
+#include "input_output.h"
+#include "memory.h"
+#include "message.h"
+#include "probe.h"
+#include "sample.h"
+#include "scoreboard.h"
+
+/* Run every job listed in the manifest file 'path' on a pool of 'threads' workers (0 picks the number of online CPUs)
+ * Every manifest line holds the six paths of one job: <cfg> <memin> <memout> <regout> <traceinst> <traceunit>
+ * All the jobs take their options (binaryTrace, sparseMemout, memorySize, functional, selfCheck, sampling and engine) from 'pOptions'
+ * The function return SUCCESS (true) if all the jobs succeeded and FAILURE (false) otherwise */
+bool batch_runManifest(char *, int, const stSimJob *);
+/* Run 'jobsNum' independent jobs on a pool of 'threads' workers, calling 'pJobFunc(pContext, jobIdx)' once per job */
+void batch_runParallel(void (*)(void *, unsigned int), void *, unsigned int, int);
+/* Run a single simulation job, all the state lives on the stack of the caller so jobs can run in parallel
+ * The output files are opened once before the simulation and every writer closes its own file
+ * On failure 'error' of the job is set to the stage that failed
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool batch_runJob(stSimJob *);
+
+#endif /* BATCH_H_ */
@@ -0,0 +1,487 @@
+#include "checkpoint.h"
+#include "input_output.h"
+#include "inst_queue.h"
+#include "memory.h"
+#include "out_buffer.h"
+#include "scoreboard.h"
+#include "trace.h"
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Read the next 'bytes' bytes of the checkpoint as a little endian number, Reading past the end marks it as failed */
+uint32_t Checkpoint_Get(stCheckpoint *, int);
+/* Read the next command of the checkpoint, An invalid command marks it as failed */
+void Checkpoint_GetCommand(stCheckpoint *, command_row_t *);
+/* Read the next FU id of the checkpoint and return its FU, or NULL for BIN_TRACE_NO_FU
+ * An id that is not a FU of the scoreboard marks the checkpoint as failed */
+stFunctionalUnit* Checkpoint_GetFU(stCheckpoint *, stScoreboardCPU *);
+/* Read the next register index of the checkpoint, An invalid index marks it as failed */
+reg_t Checkpoint_GetRegister(stCheckpoint *);
+/* Append 'value' to the checkpoint as a little endian number of 'bytes' bytes */
+void Checkpoint_Put(stOutBuffer *, uint32_t, int);
+/* Append the command to the checkpoint */
+void Checkpoint_PutCommand(stOutBuffer *, const command_row_t *);
+/* Append the id of the FU to the checkpoint, BIN_TRACE_NO_FU for NULL */
+void Checkpoint_PutFU(stOutBuffer *, stScoreboardCPU *, const stFunctionalUnit *);
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Release the checkpoint read by Checkpoint_Open(), Does nothing if no checkpoint is open */
+void Checkpoint_Close(stCheckpoint* pCheckpoint) {
+	unmap_file(pCheckpoint->pData, pCheckpoint->length);
+	pCheckpoint->pData = NULL;
+}
+
+/* Restore the configuration, the memory and the program of the checkpoint, As load_cfg(), load_memin() and
+ * decode_program() do for a new run, 'pMemory' must not be initialized and the program must be freed by the caller
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Checkpoint_LoadInputs(stCheckpoint* pCheckpoint, configuration* config, stMemory* pMemory, command_row_t** pProgram, unsigned int* pInstructionNum) {
+	unsigned short int* pNums = &(config->add_nr_units); /* The numeric fields are consecutive, as in the sweep */
+	uint32_t size = 0, pagesNum = 0, pageIdx = 0, programLength = 0, i = 0, j = 0;
+	uint32_t* pPage = NULL;
+	for (i=0; i<NUM_OF_CONFIGURATION_NUMS; ++i) {
+		pNums[i] = (unsigned short int)Checkpoint_Get(pCheckpoint, 2);
+		if (CONFIGURATION_INT_MAX_VALUE < pNums[i]) { /* Same limit as the cfg file */
+			pCheckpoint->failed = true;
+		}
+	}
+	size = Checkpoint_Get(pCheckpoint, 2);
+	if ((CONFIGURATION_STR_MAX_LENGTH < size) || (pCheckpoint->length - pCheckpoint->position < size)) {
+		pCheckpoint->failed = true;
+	} else {
+		memcpy(config->trace_unit, pCheckpoint->pData + pCheckpoint->position, size);
+		config->trace_unit[size] = '\0';
+		pCheckpoint->position += size;
+	}
+	size = Checkpoint_Get(pCheckpoint, 4);
+	if (pCheckpoint->failed || (size < MEMORY_SIZE) || (MAX_MEMORY_SIZE < size) || (Memory_Init(pMemory, size) == FAILURE)) {
+		Message_Print("[Error] The checkpoint configuration or memory size is invalid\n");
+		return FAILURE;
+	}
+	pMemory->usedSize = Checkpoint_Get(pCheckpoint, 4);
+	pagesNum = Checkpoint_Get(pCheckpoint, 4);
+	for (i=0; (i<pagesNum) && !pCheckpoint->failed; ++i) {
+		pageIdx = Checkpoint_Get(pCheckpoint, 4);
+		if ((pMemory->pagesNum <= pageIdx) || (pMemory->pPages[pageIdx] != NULL)) {
+			pCheckpoint->failed = true;
+			break;
+		}
+		pPage = (uint32_t*) malloc(MEMORY_PAGE_SIZE * sizeof(uint32_t));
+		if (!pPage) {
+			Message_Print("[Fatal] Memory page malloc failed\n");
+			Memory_Destroy(pMemory);
+			return FAILURE;
+		}
+		for (j=0; j<MEMORY_PAGE_SIZE; ++j) {
+			pPage[j] = Checkpoint_Get(pCheckpoint, 4);
+		}
+		pMemory->pPages[pageIdx] = pPage;
+	}
+	*pInstructionNum = Checkpoint_Get(pCheckpoint, 4);
+	programLength = Checkpoint_Get(pCheckpoint, 4);
+	if (pCheckpoint->failed || (pMemory->size < pMemory->usedSize) || (pMemory->size < *pInstructionNum) ||
+	    (programLength != *pInstructionNum + ((*pInstructionNum < pMemory->size) ? 1 : 0))) {
+		Message_Print("[Error] The checkpoint memory or program is invalid\n");
+		Memory_Destroy(pMemory);
+		return FAILURE;
+	}
+	*pProgram = (command_row_t*) malloc(sizeof(command_row_t) * (programLength + 1));
+	if (!*pProgram) {
+		Message_Print("[Fatal] Program decoding malloc failed\n");
+		Memory_Destroy(pMemory);
+		return FAILURE;
+	}
+	for (i=0; i<programLength; ++i) {
+		Checkpoint_GetCommand(pCheckpoint, &((*pProgram)[i]));
+	}
+	if (pCheckpoint->failed) {
+		Message_Print("[Error] The checkpoint program is invalid\n");
+		Memory_Destroy(pMemory);
+		free(*pProgram);
+		*pProgram = NULL;
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+/* Restore the rest of the state into the scoreboard initialized with the inputs of Checkpoint_LoadInputs()
+ * The traceunit file 'path' is cut back to the trace position of the checkpoint and reopened in 'pTraceOut',
+ * The trace continues on 'pTrace' which must be closed by the caller on success
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Checkpoint_LoadState(stCheckpoint* pCheckpoint, stScoreboardCPU* pCPU, stTraceFile* pTrace, stOutBuffer* pTraceOut, char* path) {
+	command_row_t cmd;
+	stFunctionalUnit* pFU = NULL;
+	stTraceRun* pRun = NULL;
+	uint16_t* pActiveIds = NULL;
+	uint32_t value = 0, queueSize = 0, activeNum = 0, lastCycle = 0, i = 0;
+	uint64_t offset = 0;
+	bool binary = false;
+	int stage = 0;
+	pCPU->cycle = Checkpoint_Get(pCheckpoint, 4);
+	pCPU->PC = Checkpoint_Get(pCheckpoint, 4);
+	pCPU->lastIssuedPC = Checkpoint_Get(pCheckpoint, 4);
+	pCPU->halted = (Checkpoint_Get(pCheckpoint, 1) != 0);
+	pCPU->engine = (int)Checkpoint_Get(pCheckpoint, 1);
+	if ((ENGINE_TOMASULO < pCPU->engine) || (pCPU->instructionNum < pCPU->PC) || (pCPU->pMemory->size <= pCPU->PC) || (pCPU->instructionNum < pCPU->lastIssuedPC)) {
+		pCheckpoint->failed = true;
+	}
+	for (i=0; i<NUM_OF_REGISTERS; ++i) {
+		value = Checkpoint_Get(pCheckpoint, 4);
+		memcpy(&(pCPU->Register[i]), &value, sizeof(float));
+	}
+	for (i=0; i<NUM_OF_REGISTERS; ++i) {
+		pCPU->registerResultStatus[i] = Checkpoint_GetFU(pCheckpoint, pCPU);
+	}
+	queueSize = Checkpoint_Get(pCheckpoint, 1);
+	for (i=0; (i<queueSize) && !pCheckpoint->failed; ++i) {
+		Checkpoint_GetCommand(pCheckpoint, &cmd);
+		if (InstQ_Enqueue(&(pCPU->InstructionQ), cmd) == FAILURE) {
+			pCheckpoint->failed = true;
+		}
+	}
+	if (Checkpoint_Get(pCheckpoint, 4) != pCPU->numOfFUs) { /* The FUs were built from the configuration of the checkpoint */
+		pCheckpoint->failed = true;
+	}
+	for (i=0; (i<pCPU->numOfFUs) && !pCheckpoint->failed; ++i) {
+		pFU = &(pCPU->pFUs[i]);
+		pFU->Busy = (Checkpoint_Get(pCheckpoint, 1) != 0);
+		pFU->Fi = Checkpoint_GetRegister(pCheckpoint);
+		pFU->Fj = Checkpoint_GetRegister(pCheckpoint);
+		pFU->Fk = Checkpoint_GetRegister(pCheckpoint);
+		pFU->Qj = Checkpoint_GetFU(pCheckpoint, pCPU);
+		pFU->Qk = Checkpoint_GetFU(pCheckpoint, pCPU);
+		pFU->Rj = (Checkpoint_Get(pCheckpoint, 1) != 0);
+		pFU->Rk = (Checkpoint_Get(pCheckpoint, 1) != 0);
+		value = Checkpoint_Get(pCheckpoint, 4);
+		memcpy(&(pFU->tempRegister), &value, sizeof(float));
+		value = Checkpoint_Get(pCheckpoint, 4);
+		memcpy(&(pFU->Vj), &value, sizeof(float));
+		value = Checkpoint_Get(pCheckpoint, 4);
+		memcpy(&(pFU->Vk), &value, sizeof(float));
+		pFU->tempImmidiate = (unsigned short int)Checkpoint_Get(pCheckpoint, 2);
+		pFU->time_left = (unsigned short int)Checkpoint_Get(pCheckpoint, 2);
+		value = Checkpoint_Get(pCheckpoint, 4);
+		pFU->relatedPC = (int)value;
+		pFU->busyCycles = Checkpoint_Get(pCheckpoint, 4);
+		pFU->lastStartCycle = Checkpoint_Get(pCheckpoint, 4);
+		if ((pCPU->instructionNum < value) || (MEMORY_SIZE <= pFU->tempImmidiate)) {
+			pCheckpoint->failed = true;
+		}
+	}
+	for (i=0; i<pCPU->numOfFUs; ++i) { /* A FU can only wait for a busy FU, or it would wait forever */
+		pFU = &(pCPU->pFUs[i]);
+		if (((pFU->Qj != NULL) && !pFU->Qj->Busy) || ((pFU->Qk != NULL) && !pFU->Qk->Busy)) {
+			pCheckpoint->failed = true;
+		}
+	}
+	for (i=0; i<NUM_OF_REGISTERS; ++i) {
+		if ((pCPU->registerResultStatus[i] != NULL) && !pCPU->registerResultStatus[i]->Busy) {
+			pCheckpoint->failed = true;
+		}
+	}
+	activeNum = Checkpoint_Get(pCheckpoint, 4);
+	if (pCheckpoint->failed || (pCPU->numOfFUs < activeNum)) {
+		Message_Print("[Error] The checkpoint scoreboard state is invalid\n");
+		return FAILURE;
+	}
+	pActiveIds = (uint16_t*) malloc((activeNum + 1) * sizeof(uint16_t));
+	if (!pActiveIds) {
+		Message_Print("[Fatal] Checkpoint malloc failed\n");
+		return FAILURE;
+	}
+	for (i=0; i<activeNum; ++i) {
+		pFU = Checkpoint_GetFU(pCheckpoint, pCPU);
+		if ((pFU == NULL) || !pFU->Busy) {
+			pCheckpoint->failed = true;
+			break;
+		}
+		pActiveIds[i] = (uint16_t)(pFU - pCPU->pFUs);
+	}
+	if (!pCheckpoint->failed) {
+		scoreboard_relinkFUs(pCPU, pActiveIds, activeNum);
+	}
+	free(pActiveIds);
+	for (stage=ISSUE_STAGE_IDX; stage<=WRITE_RESULT_STAGE_IDX; ++stage) {
+		for (i=0; i<=pCPU->instructionNum; ++i) {
+			pCPU->instructionStatus[stage][i] = Checkpoint_Get(pCheckpoint, 4);
+		}
+	}
+	for (i=0; i<=pCPU->instructionNum; ++i) {
+		pFU = Checkpoint_GetFU(pCheckpoint, pCPU);
+		pCPU->instructionFUs[i] = (pFU == NULL) ? BIN_TRACE_NO_FU : (uint16_t)(pFU - pCPU->pFUs);
+	}
+	/* The trace position, The pending runs of a binary trace are checked to fill the rest of the file exactly */
+	binary = (Checkpoint_Get(pCheckpoint, 1) != 0);
+	offset = Checkpoint_Get(pCheckpoint, 4);
+	offset |= (uint64_t)Checkpoint_Get(pCheckpoint, 4) << 32;
+	lastCycle = Checkpoint_Get(pCheckpoint, 4);
+	if (pCheckpoint->failed || ((pCheckpoint->length - pCheckpoint->position) != (binary ? (size_t)pCPU->numOfFUs * CHECKPOINT_TRACE_RUN_LENGTH : 0))) {
+		Message_Print("[Error] The checkpoint scoreboard or trace state is invalid\n");
+		return FAILURE;
+	}
+	if (OutBuf_Resume(pTraceOut, path, offset) == FAILURE) {
+		if (errno == EINVAL) {
+			Message_Print("[Error] traceunit file '%s' is shorter than the trace position of the checkpoint\n", path);
+		} else {
+			Message_Print("[Error] traceunit file '%s' can not be resumed (%s)\n", path, strerror(errno));
+		}
+		return FAILURE;
+	}
+	if (Trace_Open(pTrace, pTraceOut, binary, NULL, pCPU->FUsNum, pCPU->FUsDepth) == FAILURE) {
+		return FAILURE;
+	}
+	pTrace->lastCycle = lastCycle;
+	for (i=0; binary && (i<pCPU->numOfFUs); ++i) {
+		pRun = &(pTrace->pRuns[i]);
+		pRun->row.unitId = (uint16_t)Checkpoint_Get(pCheckpoint, 2);
+		pRun->row.Fi = (uint8_t)Checkpoint_Get(pCheckpoint, 1);
+		pRun->row.Fj = (uint8_t)Checkpoint_Get(pCheckpoint, 1);
+		pRun->row.Fk = (uint8_t)Checkpoint_Get(pCheckpoint, 1);
+		pRun->row.flags = (uint8_t)Checkpoint_Get(pCheckpoint, 1);
+		pRun->row.Qj = (uint16_t)Checkpoint_Get(pCheckpoint, 2);
+		pRun->row.Qk = (uint16_t)Checkpoint_Get(pCheckpoint, 2);
+		pRun->start = Checkpoint_Get(pCheckpoint, 4);
+		pRun->length = Checkpoint_Get(pCheckpoint, 4);
+		pRun->lastCycle = Checkpoint_Get(pCheckpoint, 4);
+	}
+	return SUCCESS;
+}
+
+/* Read the checkpoint file 'path' and check its magic and version
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Checkpoint_Open(stCheckpoint* pCheckpoint, char* path) {
+	pCheckpoint->position = 0;
+	pCheckpoint->failed = false;
+	if (map_file(path, &(pCheckpoint->pData), &(pCheckpoint->length)) == FAILURE) {
+		pCheckpoint->pData = NULL;
+		return FAILURE;
+	}
+	if ((pCheckpoint->length < 4) || (memcmp(pCheckpoint->pData, CHECKPOINT_MAGIC, 4) != 0)) {
+		Message_Print("[Error] '%s' is not a checkpoint file\n", path);
+		return FAILURE;
+	}
+	pCheckpoint->position = 4;
+	if (Checkpoint_Get(pCheckpoint, 2) != CHECKPOINT_VERSION) {
+		Message_Print("[Error] Checkpoint file '%s' has an unsupported version\n", path);
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+/* Save the whole state of the scoreboard and the position of its traceunit trace 'pTrace' to the file 'path'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Checkpoint_Save(char* path, stScoreboardCPU* pCPU, stTraceFile* pTrace) {
+	stOutBuffer out;
+	const stMemory* pMemory = pCPU->pMemory;
+	const unsigned short int* pNums = &(pCPU->pConfiguration->add_nr_units); /* The numeric fields are consecutive, as in the sweep */
+	const stFunctionalUnit* pFU = NULL;
+	const stTraceRun* pRun = NULL;
+	uint32_t pagesNum = 0, programLength = 0, value = 0, i = 0, j = 0;
+	uint64_t offset = 0;
+	int stage = 0;
+	if (pTrace == NULL) {
+		Message_Print("[Error] A checkpoint needs the traceunit file\n");
+		return FAILURE;
+	}
+	offset = OutBuf_Tell(pTrace->pOut);
+	if (open_output_file("checkpoint", path, &out) == FAILURE) {
+		return FAILURE;
+	}
+	memcpy(OutBuf_Reserve(&out), CHECKPOINT_MAGIC, 4);
+	OutBuf_Commit(&out, out.pBuffer + out.used + 4);
+	Checkpoint_Put(&out, CHECKPOINT_VERSION, 2);
+	/* The inputs, configuration, memory and the decoded program */
+	for (i=0; i<NUM_OF_CONFIGURATION_NUMS; ++i) {
+		Checkpoint_Put(&out, pNums[i], 2);
+	}
+	value = (uint32_t)strlen(pCPU->pConfiguration->trace_unit);
+	Checkpoint_Put(&out, value, 2);
+	for (i=0; i<value; ++i) {
+		Checkpoint_Put(&out, (unsigned char)pCPU->pConfiguration->trace_unit[i], 1);
+	}
+	Checkpoint_Put(&out, pMemory->size, 4);
+	Checkpoint_Put(&out, pMemory->usedSize, 4);
+	for (i=0; i<pMemory->pagesNum; ++i) {
+		pagesNum += (Memory_GetPage(pMemory, i) != NULL) ? 1 : 0;
+	}
+	Checkpoint_Put(&out, pagesNum, 4);
+	for (i=0; i<pMemory->pagesNum; ++i) { /* Pages that were never written are not saved */
+		if (Memory_GetPage(pMemory, i) != NULL) {
+			Checkpoint_Put(&out, i, 4);
+			for (j=0; j<MEMORY_PAGE_SIZE; ++j) {
+				Checkpoint_Put(&out, Memory_GetPage(pMemory, i)[j], 4);
+			}
+		}
+	}
+	programLength = pCPU->instructionNum + ((pCPU->instructionNum < pMemory->size) ? 1 : 0); /* With the HALT, if there is one */
+	Checkpoint_Put(&out, pCPU->instructionNum, 4);
+	Checkpoint_Put(&out, programLength, 4);
+	for (i=0; i<programLength; ++i) {
+		Checkpoint_PutCommand(&out, &(pCPU->pProgram[i]));
+	}
+	/* The scoreboard, FU pointers are saved as FU ids */
+	Checkpoint_Put(&out, pCPU->cycle, 4);
+	Checkpoint_Put(&out, pCPU->PC, 4);
+	Checkpoint_Put(&out, pCPU->lastIssuedPC, 4);
+	Checkpoint_Put(&out, pCPU->halted ? 1 : 0, 1);
+	Checkpoint_Put(&out, (uint32_t)pCPU->engine, 1);
+	for (i=0; i<NUM_OF_REGISTERS; ++i) {
+		memcpy(&value, &(pCPU->Register[i]), sizeof(float));
+		Checkpoint_Put(&out, value, 4);
+	}
+	for (i=0; i<NUM_OF_REGISTERS; ++i) {
+		Checkpoint_PutFU(&out, pCPU, pCPU->registerResultStatus[i]);
+	}
+	Checkpoint_Put(&out, (uint32_t)pCPU->InstructionQ.size, 1);
+	for (i=0; i<(uint32_t)pCPU->InstructionQ.size; ++i) {
+		Checkpoint_PutCommand(&out, &(pCPU->InstructionQ.m_Instr[(pCPU->InstructionQ.head + i) % INSTRUCTION_QUEUE_LENGTH]));
+	}
+	Checkpoint_Put(&out, pCPU->numOfFUs, 4);
+	for (i=0; i<pCPU->numOfFUs; ++i) {
+		pFU = &(pCPU->pFUs[i]);
+		Checkpoint_Put(&out, pFU->Busy ? 1 : 0, 1);
+		Checkpoint_Put(&out, pFU->Fi, 1);
+		Checkpoint_Put(&out, pFU->Fj, 1);
+		Checkpoint_Put(&out, pFU->Fk, 1);
+		Checkpoint_PutFU(&out, pCPU, pFU->Qj);
+		Checkpoint_PutFU(&out, pCPU, pFU->Qk);
+		Checkpoint_Put(&out, pFU->Rj ? 1 : 0, 1);
+		Checkpoint_Put(&out, pFU->Rk ? 1 : 0, 1);
+		memcpy(&value, &(pFU->tempRegister), sizeof(float));
+		Checkpoint_Put(&out, value, 4);
+		memcpy(&value, &(pFU->Vj), sizeof(float));
+		Checkpoint_Put(&out, value, 4);
+		memcpy(&value, &(pFU->Vk), sizeof(float));
+		Checkpoint_Put(&out, value, 4);
+		Checkpoint_Put(&out, pFU->tempImmidiate, 2);
+		Checkpoint_Put(&out, pFU->time_left, 2);
+		Checkpoint_Put(&out, (uint32_t)pFU->relatedPC, 4);
+		Checkpoint_Put(&out, pFU->busyCycles, 4);
+		Checkpoint_Put(&out, pFU->lastStartCycle, 4);
+	}
+	Checkpoint_Put(&out, pCPU->activeFUs, 4);
+	for (pFU=pCPU->pActiveHead; pFU!=NULL; pFU=pFU->pNextActive) { /* In issue order, The consumer lists are rebuilt from it */
+		Checkpoint_PutFU(&out, pCPU, pFU);
+	}
+	for (stage=ISSUE_STAGE_IDX; stage<=WRITE_RESULT_STAGE_IDX; ++stage) {
+		for (i=0; i<=pCPU->instructionNum; ++i) {
+			Checkpoint_Put(&out, pCPU->instructionStatus[stage][i], 4);
+		}
+	}
+	for (i=0; i<=pCPU->instructionNum; ++i) {
+		Checkpoint_Put(&out, pCPU->instructionFUs[i], 2);
+	}
+	/* The trace position, The pending runs of a binary trace are not written to the file yet */
+	Checkpoint_Put(&out, pTrace->binary ? 1 : 0, 1);
+	Checkpoint_Put(&out, (uint32_t)offset, 4);
+	Checkpoint_Put(&out, (uint32_t)(offset >> 32), 4);
+	Checkpoint_Put(&out, pTrace->lastCycle, 4);
+	for (i=0; pTrace->binary && (i<pCPU->numOfFUs); ++i) {
+		pRun = &(pTrace->pRuns[i]);
+		Checkpoint_Put(&out, pRun->row.unitId, 2);
+		Checkpoint_Put(&out, pRun->row.Fi, 1);
+		Checkpoint_Put(&out, pRun->row.Fj, 1);
+		Checkpoint_Put(&out, pRun->row.Fk, 1);
+		Checkpoint_Put(&out, pRun->row.flags, 1);
+		Checkpoint_Put(&out, pRun->row.Qj, 2);
+		Checkpoint_Put(&out, pRun->row.Qk, 2);
+		Checkpoint_Put(&out, pRun->start, 4);
+		Checkpoint_Put(&out, pRun->length, 4);
+		Checkpoint_Put(&out, pRun->lastCycle, 4);
+	}
+	if (pTrace->pOut->failed) { /* OutBuf_Tell() failed */
+		OutBuf_Close(&out);
+		return FAILURE;
+	}
+	return OutBuf_Close(&out);
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Read the next 'bytes' bytes of the checkpoint as a little endian number, Reading past the end marks it as failed */
+uint32_t Checkpoint_Get(stCheckpoint* pCheckpoint, int bytes) {
+	const unsigned char* pSrc = (const unsigned char*)pCheckpoint->pData + pCheckpoint->position;
+	uint32_t value = 0;
+	int i = 0;
+	if (pCheckpoint->failed || (pCheckpoint->length - pCheckpoint->position < (size_t)bytes)) {
+		pCheckpoint->failed = true;
+		return 0;
+	}
+	for (i=bytes-1; 0<=i; --i) {
+		value = (value << 8) | pSrc[i];
+	}
+	pCheckpoint->position += (size_t)bytes;
+	return value;
+}
+
+/* Read the next command of the checkpoint, An invalid command marks it as failed */
+void Checkpoint_GetCommand(stCheckpoint* pCheckpoint, command_row_t* pCmd) {
+	uint32_t opcode = Checkpoint_Get(pCheckpoint, 1);
+	if (OPCODE_HALT < opcode) {
+		pCheckpoint->failed = true;
+	}
+	pCmd->opcode = (opcode_t)opcode;
+	pCmd->dst = Checkpoint_GetRegister(pCheckpoint);
+	pCmd->src0 = Checkpoint_GetRegister(pCheckpoint);
+	pCmd->src1 = Checkpoint_GetRegister(pCheckpoint);
+	pCmd->imm = (unsigned short int)Checkpoint_Get(pCheckpoint, 2);
+	if (MEMORY_SIZE <= pCmd->imm) { /* The immediate has 12 bits */
+		pCheckpoint->failed = true;
+	}
+	pCmd->srcMask = (uint16_t)Checkpoint_Get(pCheckpoint, 2);
+	pCmd->dstMask = (uint16_t)Checkpoint_Get(pCheckpoint, 2);
+}
+
+/* Read the next FU id of the checkpoint and return its FU, or NULL for BIN_TRACE_NO_FU
+ * An id that is not a FU of the scoreboard marks the checkpoint as failed */
+stFunctionalUnit* Checkpoint_GetFU(stCheckpoint* pCheckpoint, stScoreboardCPU* pCPU) {
+	uint32_t id = Checkpoint_Get(pCheckpoint, 2);
+	if (id == BIN_TRACE_NO_FU) {
+		return NULL;
+	}
+	if (pCPU->numOfFUs <= id) {
+		pCheckpoint->failed = true;
+		return NULL;
+	}
+	return &(pCPU->pFUs[id]);
+}
+
+/* Read the next register index of the checkpoint, An invalid index marks it as failed */
+reg_t Checkpoint_GetRegister(stCheckpoint* pCheckpoint) {
+	uint32_t reg = Checkpoint_Get(pCheckpoint, 1);
+	if (NUM_OF_REGISTERS <= reg) {
+		pCheckpoint->failed = true;
+		return REGISTER_F0;
+	}
+	return int_to_reg((int)reg);
+}
+
+/* Append 'value' to the checkpoint as a little endian number of 'bytes' bytes */
+void Checkpoint_Put(stOutBuffer* pOut, uint32_t value, int bytes) {
+	char* pDst = OutBuf_Reserve(pOut);
+	int i = 0;
+	for (i=0; i<bytes; ++i) {
+		pDst[i] = (char)(value & 0xFF);
+		value = value >> 8;
+	}
+	OutBuf_Commit(pOut, pDst + bytes);
+}
+
+/* Append the command to the checkpoint */
+void Checkpoint_PutCommand(stOutBuffer* pOut, const command_row_t* pCmd) {
+	Checkpoint_Put(pOut, (uint32_t)pCmd->opcode, 1);
+	Checkpoint_Put(pOut, (uint32_t)pCmd->dst, 1);
+	Checkpoint_Put(pOut, (uint32_t)pCmd->src0, 1);
+	Checkpoint_Put(pOut, (uint32_t)pCmd->src1, 1);
+	Checkpoint_Put(pOut, pCmd->imm, 2);
+	Checkpoint_Put(pOut, pCmd->srcMask, 2);
+	Checkpoint_Put(pOut, pCmd->dstMask, 2);
+}
+
+/* Append the id of the FU to the checkpoint, BIN_TRACE_NO_FU for NULL */
+void Checkpoint_PutFU(stOutBuffer* pOut, stScoreboardCPU* pCPU, const stFunctionalUnit* pFU) {
+	Checkpoint_Put(pOut, (pFU == NULL) ? BIN_TRACE_NO_FU : (uint32_t)(pFU - pCPU->pFUs), 2);
+}
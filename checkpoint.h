@@ -0,0 +1,25 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include "defines.h"
+#include "message.h"
+
+/* Release the checkpoint read by Checkpoint_Open(), Does nothing if no checkpoint is open */
+void Checkpoint_Close(stCheckpoint *);
+/* Restore the configuration, the memory and the program of the checkpoint, As load_cfg(), load_memin() and
+ * decode_program() do for a new run, 'pMemory' must not be initialized and the program must be freed by the caller
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Checkpoint_LoadInputs(stCheckpoint *, configuration *, stMemory *, command_row_t **, unsigned int *);
+/* Restore the rest of the state into the scoreboard initialized with the inputs of Checkpoint_LoadInputs()
+ * The traceunit file 'path' is cut back to the trace position of the checkpoint and reopened in 'pTraceOut',
+ * The trace continues on 'pTrace' which must be closed by the caller on success
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Checkpoint_LoadState(stCheckpoint *, stScoreboardCPU *, stTraceFile *, stOutBuffer *, char *);
+/* Read the checkpoint file 'path' and check its magic and version
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Checkpoint_Open(stCheckpoint *, char *);
+/* Save the whole state of the scoreboard and the position of its traceunit trace 'pTrace' to the file 'path'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Checkpoint_Save(char *, stScoreboardCPU *, stTraceFile *);
+
+#endif /* CHECKPOINT_H_ */
@@ -5,9 +5,15 @@
 #include "unistd.h"
 #else /* Linux */
 #define _GNU_SOURCE /* Define S_IFDIR and getline() for Linux systems */
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #endif /* _WIN32 */
 #include <errno.h>
+#include <fcntl.h>
 #include <math.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -16,29 +22,121 @@
 #include <sys/stat.h>
 
 #define DEBUG				false /* Turn on the printing */
+#define EVENT_DRIVEN_CYCLES		true /* Skip over cycles in which no FU changes its state */
+#ifndef PROBE_MODE /* Chosen at build time with 'make PROBES=NONE|RING|CALLBACK' */
+#define PROBE_MODE			PROBE_MODE_NONE
+#endif /* PROBE_MODE */
 
+#define BIN_TRACE_FLAG_QJ		0x4 /* The Qj FU id of the row is valid */
+#define BIN_TRACE_FLAG_QK		0x8 /* The Qk FU id of the row is valid */
+#define BIN_TRACE_FLAG_RJ		0x1
+#define BIN_TRACE_FLAG_RK		0x2
+#define BIN_TRACE_HEADER_LENGTH		30 /* Magic, version and the number of FUs and the pipeline depth of every type */
+#define BIN_TRACE_INST_MAGIC		"SBTI"
+#define BIN_TRACE_INST_RECORD_LENGTH	22
+#define BIN_TRACE_NO_FU			0xFFFF
+#define BIN_TRACE_UNIT_MAGIC		"SBTU"
+#define BIN_TRACE_UNIT_RECORD_LENGTH	18
+#define BIN_TRACE_VERSION		2
+#define CFG_FILE_IDX			0
+#define CHECKPOINT_MAGIC		"SBCP"
+#define CHECKPOINT_TRACE_RUN_LENGTH	22 /* Bytes of the pending run of one unit of a binary traceunit */
+#define CHECKPOINT_VERSION		4
 #define CHECK_INPUT_FILE		true
 #define CHECK_OUTPUT_FILE		false
 #define CONFIGURATION_INT_MAX_VALUE	4096
-#define CONFIGURATION_NAME_MAX_LENGTH	15
-#define CONFIGURATION_STR_MAX_LENGTH	5
+#define CONFIGURATION_LINE_MAX_LENGTH	(CONFIGURATION_NAME_MAX_LENGTH + 1 + CONFIGURATION_STR_MAX_LENGTH) /* A cfg line without its spaces */
+#define CONFIGURATION_NAME_MAX_LENGTH	18 /* 'add_pipeline_depth' */
+#define CONFIGURATION_NUM_NAMES		{ \
+	"add_nr_units", "sub_nr_units", "mul_nr_units", "div_nr_units", "ld_nr_units", "st_nr_units", \
+	"add_delay", "sub_delay", "mul_delay", "div_delay", "ld_delay", "st_delay", "fetch_width", "issue_width", \
+	"add_pipeline_depth", "sub_pipeline_depth", "mul_pipeline_depth", "div_pipeline_depth", "ld_pipeline_depth", "st_pipeline_depth", \
+	"add_init_interval", "sub_init_interval", "mul_init_interval", "div_init_interval", "ld_init_interval", "st_init_interval" }
+#define CONFIGURATION_REQUIRED_BITS	(((1u << NUM_OF_REQUIRED_CONFIGURATION_NUMS) - 1) | CONFIGURATION_TRACE_UNIT_BIT) /* Of the fields read by load_cfg() */
+#define CONFIGURATION_TRACE_UNIT_BIT	(1u << NUM_OF_CONFIGURATION_NUMS) /* After the bits of the numeric fields */
+#define CONFIGURATION_STR_MAX_LENGTH	255 /* trace_unit can list many units */
+#define DEFAULT_BATCH_THREADS		4 /* Used when the number of online CPUs is unknown */
+#define DEFAULT_OPTIONAL_CFG_VALUE	1 /* Every optional field of a cfg file that does not set it, The widths, depths and intervals */
+#define ENGINE_SCOREBOARD		0 /* The default engine, Stalls the issue on WAW and the write result on WAR */
+#define ENGINE_TOMASULO			1 /* Register renaming, The FUs are the reservation stations and results go on one common data bus */
 #define EXECUTE_END_STAGE_IDX		2
 #define FAILURE				false
+#define FREE_FUS_WORD_BITS		64 /* Bits in every word of the free FUs bitmap */
+#define FREE_FUS_WORDS			(CONFIGURATION_INT_MAX_VALUE / FREE_FUS_WORD_BITS)
+#define FU_TYPE_NAMES			{ "LD", "ST", "ADD", "SUB", "MUL", "DIV" } /* Indexed by opcode */
 #define INSTRUCTION_QUEUE_LENGTH	16
 #define ISSUE_STAGE_IDX			0
-#define MAX_LENGTH_OF_FU_NAME		5
-#define MEMORY_SIZE			4096
+#define ISSUE_STALL_HALT_IDX		0 /* The HALT at the head of the queue waits for the FUs to drain */
+#define ISSUE_STALL_QUEUE_EMPTY_IDX	1
+#define ISSUE_STALL_STRUCTURAL_IDX	2 /* No FU of the type is free */
+#define ISSUE_STALL_WAW_IDX		3 /* The destination register still waits for the result of another FU */
+#define MAX_BATCH_THREADS		256
+#define MAX_LENGTH_OF_FU_NAME		12 /* Longest names are 'ADD4095' and slots of pipelined units like 'ADD2047.1' */
+#define MAX_PIPELINE_DEPTH		16 /* Commands one pipelined unit can hold at once */
+#define MAX_MEMORY_SIZE			(1u << 28) /* Words, The page table of the largest memory is 2MB */
+#define MAX_SWEEP_POINTS		1000000
+#define MEMIN_FILE_IDX			1
+#define MEMORY_PAGE_BITS		10
+#define MEMORY_PAGE_SIZE		(1u << MEMORY_PAGE_BITS) /* Words, Memory pages are allocated on their first write */
+#define MEMORY_SIZE			4096 /* The default (and smallest) memory size in words, Every LD/ST immediate fits in it */
+#define MEMOUT_FILE_IDX			2
+#define MESSAGE_MAX_LENGTH		1024 /* Longest printed message with its job prefix, Longer messages are cut */
+#define NUM_OF_CONFIGURATION_NUMS	26 /* The 'unsigned short int' fields of the configuration */
+#define NUM_OF_FU_TYPES			6 /* One FU type for every opcode except HALT */
+#define NUM_OF_ISSUE_STALLS		4 /* The ISSUE_STALL_*_IDX reasons */
+#define NUM_OF_OUTPUT_FILES		8 /* The sim files and the stats and probes reports, Indexed by the *_FILE_IDX defines */
+#define NUM_OF_PROBES			7 /* The PROBE_*_IDX probe points */
 #define NUM_OF_REGISTERS		16
+#define NUM_OF_REQUIRED_CONFIGURATION_NUMS	12 /* The fields every cfg and sweep file must set, The fields after them are optional */
+#define NUM_OF_SIM_FILES		6 /* cfg, memin, memout, regout, traceinst and traceunit */
+#define OUTPUT_BUFFER_SIZE		(1 << 20) /* Bytes buffered before every write() */
+#define OUTPUT_LINE_MAX_LENGTH		128 /* Longest line of any output file, traceunit lines are ~70 bytes */
+#define PROBE_EXEC_DONE_IDX		4
+#define PROBE_FETCH_IDX			0
+#define PROBE_ISSUE_IDX			1
+#define PROBE_ISSUE_STALL_IDX		2 /* The FU is the one the destination waits for on a WAW stall */
+#define PROBE_MODE_CALLBACK		2 /* Every probe calls its entry of the callback table of the CPU */
+#define PROBE_MODE_NONE			0 /* The probes compile to nothing */
+#define PROBE_MODE_RING			1 /* Every probe appends an event to the ring buffer of the CPU */
+#define PROBE_NAMES			{ "fetch", "issue", "issue-stall", "read-operands", "exec-done", "writeback", "war-stall" }
+#define PROBE_NO_FU			(-1)
+#define PROBE_READ_BATCH		1024 /* Events the reader of a probe session moves out of the ring at once */
+#define PROBE_READ_OPERANDS_IDX		3
+#define PROBE_SESSION_RING_SIZE		(1u << 18) /* Events the ring of a probe session holds, 3MB */
+#define PROBE_WAR_STALL_IDX		6
+#define PROBE_WRITEBACK_IDX		5
+#define PROBES_FILE_IDX			7
 #define READ_REGISTERS_STAGE_IDX	1
+#define REGOUT_FILE_IDX			3
+#define SAMPLE_CONFIDENCE_Z		1.96 /* Normal quantile of the 95% confidence interval of a sampled run */
+#define STATS_FILE_IDX			6
 #define SUCCESS				true
+#define TRACEINST_FILE_IDX		4
+#define TRACE_ALL_UNITS			"ALL" /* trace_unit value that traces every FU */
+#define TRACEUNIT_FILE_IDX		5
 #define WRITE_RESULT_STAGE_IDX		3
 
 typedef struct configuration_Name	configuration;
+typedef struct stCheckpoint_name	stCheckpoint;
 typedef struct command_row_t_Name	command_row_t;
 typedef struct InstQ_name		InstQ;
-typedef struct Node_t			NODE;
+typedef struct stOutBuffer_name		stOutBuffer;
+typedef struct stFreeFUs_Name		stFreeFUs;
 typedef struct stFunctionalUnit_Name	stFunctionalUnit;
+typedef struct stMemory_name		stMemory;
+typedef struct stProbeEvent_name	stProbeEvent;
+typedef struct stProbeSession_name	stProbeSession;
+typedef struct stProbes_name		stProbes;
+typedef struct stSampleResult_name	stSampleResult;
 typedef struct stScoreboardCPU_name	stScoreboardCPU;
+typedef struct stSimJob_name		stSimJob;
+typedef struct stStats_name		stStats;
+typedef struct stSweep_Name		stSweep;
+typedef struct stSweepResult_Name	stSweepResult;
+typedef struct stTraceFile_name		stTraceFile;
+typedef struct stTraceRow_name		stTraceRow;
+typedef struct stTraceRun_name		stTraceRun;
+typedef struct stWorkerPool_name	stWorkerPool;
 typedef union  utInstruction_name	utInstruction;
 
 typedef enum {
@@ -70,6 +168,9 @@ typedef enum {
 	REGISTER_F15	= 15,
 } reg_t;
 
+/* A probe callback gets the context of its table, the PROBE_*_IDX probe, the cycle, the PC and the FU id */
+typedef void (*probe_callback_t)(void *, int, uint32_t, int, int);
+
 /************************************************************************/
 /*	Struct's declaration						*/
 /************************************************************************/
@@ -87,7 +188,21 @@ struct configuration_Name {
 	unsigned short int div_delay;			/* The delay for DIV operation */
 	unsigned short int ld_delay;			/* The delay for LD operation */
 	unsigned short int st_delay;			/* The delay for ST operation */
-	char trace_unit[CONFIGURATION_STR_MAX_LENGTH+1];/* Command name for the traceunit file */
+	unsigned short int fetch_width;			/* How many commands are fetched every cycle */
+	unsigned short int issue_width;			/* How many commands are issued every cycle, In order */
+	unsigned short int add_pipeline_depth;		/* How many ADD operation one ADD unit holds at once */
+	unsigned short int sub_pipeline_depth;		/* How many SUB operation one SUB unit holds at once */
+	unsigned short int mul_pipeline_depth;		/* How many MUL operation one MUL unit holds at once */
+	unsigned short int div_pipeline_depth;		/* How many DIV operation one DIV unit holds at once */
+	unsigned short int ld_pipeline_depth;		/* How many LD operation one LD unit holds at once */
+	unsigned short int st_pipeline_depth;		/* How many ST operation one ST unit holds at once */
+	unsigned short int add_init_interval;		/* Cycles between two ADD operation starting on one unit */
+	unsigned short int sub_init_interval;		/* Cycles between two SUB operation starting on one unit */
+	unsigned short int mul_init_interval;		/* Cycles between two MUL operation starting on one unit */
+	unsigned short int div_init_interval;		/* Cycles between two DIV operation starting on one unit */
+	unsigned short int ld_init_interval;		/* Cycles between two LD operation starting on one unit */
+	unsigned short int st_init_interval;		/* Cycles between two ST operation starting on one unit */
+	char trace_unit[CONFIGURATION_STR_MAX_LENGTH+1];/* Comma separated FU names for the traceunit file, or ALL */
 };
 
 /* Command struct */
@@ -97,20 +212,23 @@ struct command_row_t_Name {
 	reg_t src0;					/* Command source 0 register */
 	reg_t src1;					/* Command source 1 register */
 	unsigned short int imm;				/* Command immediate */
+	uint16_t srcMask;				/* Bit per register the command reads */
+	uint16_t dstMask;				/* Bit per register the command writes */
 };
 
-/* The HEAD of the Queue, hold the amount of node's that are in the queue */
+/* The instruction Queue, a fixed capacity ring buffer that holds the fetched commands */
 struct InstQ_name {
-	NODE* head;
-	NODE* tail;
+	command_row_t m_Instr[INSTRUCTION_QUEUE_LENGTH];
+	int head;
 	int size;
 	int limit;
 };
 
-/* A link in the queue, holds the info and point to the next Node */
-struct Node_t {
-	command_row_t  m_Instr;
-	struct Node_t* prev;
+/* Two level bitmap of the free FUs of one type, Bit b of words[w] is on when FU (w * 64 + b) is free
+ * and bit w of 'summary' is on when words[w] has at least one free FU */
+struct stFreeFUs_Name {
+	uint64_t		summary;
+	uint64_t		words[FREE_FUS_WORDS];
 };
 
 struct stFunctionalUnit_Name {
@@ -126,30 +244,213 @@ struct stFunctionalUnit_Name {
 	/* These are not part of the classic scoreboard, but used for the simlutaion */
 	char			fuName[MAX_LENGTH_OF_FU_NAME];
 	float			tempRegister;
+	float			Vj; /* Tomasulo engine, The value of Fj once it is ready (Qj is NULL) */
+	float			Vk; /* Tomasulo engine, The value of Fk once it is ready (Qk is NULL) */
 	unsigned short int	tempImmidiate;
 	unsigned short int	time_left;
 	int			relatedPC;
+	uint32_t		busyCycles; /* Cycles this FU was busy, counted when it writes its result */
+	uint32_t		lastStartCycle; /* Kept on slot 0 of a pipelined unit, When the unit last started an execution */
+	stFunctionalUnit*	pNextActive; /* The next active FU, in issue order */
+	stFunctionalUnit*	pPrevActive; /* The previous active FU, in issue order */
+	stFunctionalUnit*	pWaitingJ; /* The first FU that waits for this FU result as Qj */
+	stFunctionalUnit*	pWaitingK; /* The first FU that waits for this FU result as Qk */
+	stFunctionalUnit*	pNextWaitingJ; /* The next FU that waits on the same Qj producer */
+	stFunctionalUnit*	pNextWaitingK; /* The next FU that waits on the same Qk producer */
 };
 
 struct stScoreboardCPU_name {
 	configuration*		pConfiguration;
-	uint32_t*		pMemory;
+	stMemory*		pMemory;
+	command_row_t*		pProgram; /* The commands decoded from memin, up to and including the HALT */
+	unsigned int		instructionNum; /* The number of commands before the HALT */
 	uint32_t		PC;
 	uint32_t		cycle;
 	uint32_t		lastIssuedPC;
 	float			Register[NUM_OF_REGISTERS];
 	uint32_t*		instructionStatus[4]; /* For logging the instruction cycles */
-	char**			instructionFUs;	/* For logging the instruction active FUs */
-	stFunctionalUnit*	pTracedUnit; /* Pointer to the traced functional unit */
+	uint16_t*		instructionFUs;	/* For logging, The FU id of every instruction or BIN_TRACE_NO_FU */
+	stFunctionalUnit**	pTracedUnits; /* The traced functional units, in FU id order */
+	unsigned int		tracedUnitsNum;
+	stTraceRow*		pTraceRows; /* The rows of the traced units of one cycle */
 	stFunctionalUnit*	registerResultStatus[NUM_OF_REGISTERS];
-	InstQ*			InstructionQ;
-	stFunctionalUnit*	pLD_FUs;
-	stFunctionalUnit*	pST_FUs;
-	stFunctionalUnit*	pADD_FUs;
-	stFunctionalUnit*	pSUB_FUs;
-	stFunctionalUnit*	pMULT_FUs;
-	stFunctionalUnit*	pDIV_FUs;
+	InstQ			InstructionQ;
+	stFunctionalUnit*	pFUs; /* All the FUs, grouped by type in opcode order, Slot 's' of unit 'u' is FU s * units + u of its type */
+	unsigned int		numOfFUs;
+	unsigned int		FUsOffset[NUM_OF_FU_TYPES]; /* Index in pFUs of the first FU of every type */
+	unsigned int		FUsNum[NUM_OF_FU_TYPES]; /* Number of FUs of every type, Every slot of a pipelined unit is a FU */
+	unsigned int		FUsDepth[NUM_OF_FU_TYPES]; /* The slots of every unit of the type */
+	unsigned short int	FUsDelay[NUM_OF_FU_TYPES]; /* The execution delay of every type */
+	unsigned short int	FUsInterval[NUM_OF_FU_TYPES]; /* The initiation interval of every unit of the type */
+	stFreeFUs		freeFUs[NUM_OF_FU_TYPES];
 	bool			halted;
+	int			engine; /* ENGINE_SCOREBOARD or ENGINE_TOMASULO */
+	stFunctionalUnit*	pActiveHead; /* The oldest issued FU that is still active */
+	stFunctionalUnit*	pActiveTail; /* The youngest issued FU that is still active */
+	uint32_t		activeFUs; /* The number of in-flight FUs */
+	char*			pCheckpointPath; /* Where to save a checkpoint when 'checkpointCycle' starts, NULL for none */
+	uint32_t		checkpointCycle;
+	stStats*		pStats; /* The stall counters, NULL if they are not kept */
+	stProbes*		pProbes; /* The attached probes, NULL for none, Unused when PROBE_MODE is PROBE_MODE_NONE */
+};
+
+/* The outcome of a sampled run, The total cycles are extrapolated from the cycles per instruction of the windows */
+struct stSampleResult_name {
+	uint32_t		windowsNum;
+	uint32_t		detailedInstructions; /* The instructions of all the windows */
+	double			cycles; /* The estimated total cycles */
+	double			confidence; /* Half width of the 95% confidence interval of 'cycles', 0 with a single window */
+};
+
+/* One simulation run, the files it reads and writes and how it ended */
+struct stSimJob_name {
+	char*			paths[NUM_OF_SIM_FILES]; /* Indexed by the *_FILE_IDX defines */
+	const char*		error; /* NULL if the job succeeded, otherwise the stage that failed */
+	unsigned int		line; /* The manifest line that defined the job (batch mode) */
+	bool			binaryTrace; /* Write traceinst and traceunit in the binary trace format */
+	bool			sparseMemout; /* Write only the memout words that differ from memin */
+	uint32_t		memorySize; /* In words */
+	bool			functional; /* Run only the timing free engine, No trace files are written */
+	bool			selfCheck; /* Check the results of the timing engine against the timing free engine */
+	char*			checkpointPath; /* Save a checkpoint when 'checkpointCycle' starts, NULL for none */
+	uint32_t		checkpointCycle;
+	char*			restorePath; /* Resume the checkpoint instead of loading cfg and memin, NULL for a new run */
+	uint32_t		samplePeriod; /* In instructions, 0 for a full run, Otherwise a sampled run without trace files */
+	uint32_t		detailWindow; /* The instructions simulated in detail at the start of every sample period */
+	stSampleResult		sample; /* The estimate of a sampled run */
+	char*			statsPath; /* Where to write the stall statistics report (JSON), NULL for none */
+	int			engine; /* ENGINE_SCOREBOARD or ENGINE_TOMASULO, A restored run takes it from the checkpoint */
+	char*			probesPath; /* Where to write the probe event counts (JSON), NULL for none, Needs a probes build */
+};
+
+/* A checkpoint file being restored, read field by field from its start */
+struct stCheckpoint_name {
+	char*			pData; /* NULL if no checkpoint is open */
+	size_t			length;
+	size_t			position;
+	bool			failed; /* A read ran past the end of the file or found an invalid value */
+};
+
+/* A sparse paged memory, Pages are allocated on their first write so the cost follows the used footprint */
+struct stMemory_name {
+	uint32_t**		pPages; /* One entry for every page, NULL until the page is written, A missing page reads as zero */
+	uint32_t		pagesNum;
+	uint32_t		size; /* In words */
+	uint32_t		usedSize; /* One past the highest address that was ever written */
+	bool			failed; /* A page malloc failed, reported by the simulation */
+};
+
+/* Why the cycles were lost, Every cycle of the run is counted once in 'queueOccupancy' and once in 'issueStalls'
+ * unless a command was issued in it, Quiet cycles skipped by the event driven engine are counted as well */
+struct stStats_name {
+	uint64_t		issueStalls[NUM_OF_ISSUE_STALLS]; /* Indexed by the ISSUE_STALL_*_IDX defines */
+	uint64_t		fetchStalls; /* Cycles a full queue stalled the fetch */
+	uint64_t		rawStalls; /* FU cycles spent waiting for operands (RAW) */
+	uint64_t		warStalls; /* FU cycles spent waiting to write the result (WAR) */
+	uint64_t		cdbStalls; /* FU cycles spent waiting for the common data bus (Tomasulo engine) */
+	uint64_t		queueOccupancy[INSTRUCTION_QUEUE_LENGTH + 1]; /* Cycles that ended with every number of queued commands */
+};
+
+/* One event of a probe point, As kept by the ring buffer of PROBE_MODE_RING */
+struct stProbeEvent_name {
+	uint32_t		cycle;
+	int32_t			pc; /* The index of the command in the program */
+	int16_t			fuId; /* The FU id or PROBE_NO_FU */
+	uint8_t			probe; /* PROBE_*_IDX */
+};
+
+/* The probes attached to one CPU, The ring is written only by the simulation and read only by Probe_RingRead(),
+ * Each side stores only its own index so they need no lock */
+struct stProbes_name {
+	probe_callback_t	callbacks[NUM_OF_PROBES]; /* PROBE_MODE_CALLBACK, A NULL entry skips its probe */
+	void*			pContext; /* Passed to every callback */
+	stProbeEvent*		pRing; /* PROBE_MODE_RING, 'ringSize' events */
+	uint32_t		ringSize; /* A power of two */
+	uint32_t		ringHead; /* Events written, Stored only by the simulation */
+	uint32_t		ringTail; /* Events read, Stored only by Probe_RingRead() */
+	uint64_t		dropped; /* Events lost while the ring was full */
+};
+
+/* The probes attached to one run, Every event is counted by its probe, With PROBE_MODE_RING a reader thread drains
+ * the ring while the simulation runs */
+struct stProbeSession_name {
+	stProbes		probes;
+	uint64_t		counts[NUM_OF_PROBES]; /* Indexed by the PROBE_*_IDX defines */
+#ifndef _WIN32
+	pthread_t		reader;
+#endif /* _WIN32 */
+	uint32_t		isStopped; /* Stored once the run ended, The reader drains what is left and exits */
+};
+
+/* An output file written through one large buffer with write() */
+struct stOutBuffer_name {
+	int			fd;
+	char*			pBuffer; /* OUTPUT_BUFFER_SIZE bytes */
+	size_t			used;
+	bool			failed; /* A write() failed, reported by OutBuf_Close() */
+};
+
+/* The state of a traced unit in one cycle */
+struct stTraceRow_name {
+	uint16_t		unitId; /* Index of the FU in pFUs */
+	uint8_t			Fi;
+	uint8_t			Fj;
+	uint8_t			Fk;
+	uint8_t			flags; /* BIN_TRACE_FLAG_* */
+	uint16_t		Qj; /* FU id, BIN_TRACE_NO_FU if none */
+	uint16_t		Qk; /* FU id, BIN_TRACE_NO_FU if none */
+};
+
+/* A run of identical traceunit rows of one unit on consecutive cycles */
+struct stTraceRun_name {
+	stTraceRow		row;
+	uint32_t		start; /* The cycle of the first row */
+	uint32_t		length; /* 0 if there is no pending run */
+	uint32_t		lastCycle; /* The last cycle of the previous run of the unit, Runs are delta encoded from it */
+};
+
+/* A trace output file, Either the text format or the binary format
+ * Binary traceunit rows are run length encoded per unit, Every unit has one pending run */
+struct stTraceFile_name {
+	stOutBuffer*		pOut; /* Owned by the caller */
+	bool			binary;
+	uint16_t		fuCounts[NUM_OF_FU_TYPES]; /* Number of FUs of every type, FU names are derived from it */
+	uint16_t		fuDepths[NUM_OF_FU_TYPES]; /* The pipeline depth of every type, FU names are derived from it */
+	unsigned int		fuNum;
+	char*			pFUNames; /* MAX_LENGTH_OF_FU_NAME bytes for every FU id, Only for the text format */
+	stTraceRun*		pRuns; /* The pending run of every unit, indexed by FU id, Only for the binary format */
+	uint32_t		lastCycle; /* traceinst issue cycles are delta encoded from the previous record */
+};
+
+/* A configuration sweep, the values of every numeric configuration field and the inputs shared by all the points
+ * Every point of the cartesian product of the values is simulated, the first field changes the slowest */
+struct stSweep_Name {
+	unsigned short int*	pValues[NUM_OF_CONFIGURATION_NUMS]; /* In the order of the 'configuration' fields */
+	unsigned int		valuesNum[NUM_OF_CONFIGURATION_NUMS];
+	unsigned int		pointsNum;
+	stMemory		memory; /* The initial memory image, every point runs on its own copy */
+	command_row_t*		pProgram; /* The decoded program, read only and shared by all the points */
+	unsigned int		instructionNum;
+	int			engine; /* ENGINE_SCOREBOARD or ENGINE_TOMASULO, The same for all the points */
+	stSweepResult*		pResults;
+};
+
+/* The outcome of one sweep point */
+struct stSweepResult_Name {
+	uint32_t		cycles;
+	float			utilization[NUM_OF_FU_TYPES]; /* Busy cycles over available cycles, per FU type */
+	const char*		error; /* NULL if the point succeeded, otherwise the stage that failed */
+};
+
+/* Shared state of the batch worker threads, every worker takes the next job until none are left */
+struct stWorkerPool_name {
+	void			(*pJobFunc)(void *, unsigned int);
+	void*			pContext;
+	unsigned int		jobsNum;
+	unsigned int		nextJob;
+#ifndef _WIN32
+	pthread_mutex_t		lock;
+#endif /* _WIN32 */
 };
 
 union utInstruction_name {
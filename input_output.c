@@ -3,17 +3,16 @@
 /************************************************************************/
 /*	Private functions prototypes					*/
 /************************************************************************/
-/* Function to remove all spaces and tabs from a given string
- * Source: https://stackoverflow.com/a/1514740 */
-void trim(char *, char **);
-/* The function recieved a configuration line with 'unsigned short int',
- * if its a valid configuration line, the parsed value will be stored at 'output_value'
+/* Copy the cfg line from 'pLine' up to 'pLineEnd' to 'text' without its spaces and tabs, The line ends at the first
+ * '\r' as well, 'text' holds up to CONFIGURATION_LINE_MAX_LENGTH characters and its terminator
+ * The length of the copied text is returned, CONFIGURATION_LINE_MAX_LENGTH + 1 if the line does not fit */
+size_t compact_cfg_line(const char *, const char *, char *);
+/* Parse the decimal value of a numeric cfg field into 'pValue', It must be between 0 and CONFIGURATION_INT_MAX_VALUE
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool validate_conf_num(char *, char *, unsigned short int *);
-/* The function recieved a configuration line with 'char*',
- * if its a valid configuration line, the parsed value will be stored at 'output_value'
+bool parse_cfg_num(const char *, unsigned short int *);
+/* Parse a memin line of 'length' characters (without the '\n') into 'value'
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool validate_conf_str(char *, char *, char []);
+bool parse_memin_line(const char *, size_t, unsigned int *);
 
 #ifdef _WIN32
 size_t getline(char **, size_t *, FILE *);
@@ -31,19 +30,19 @@ bool check_files_permission(char* message, char* path, bool path_is_input) {
 			return SUCCESS;
 		}
 		if (errno == ENOENT) {
-			printf("[Error] %s file '%s' does not exist\n", message, path);
+			Message_Print("[Error] %s file '%s' does not exist\n", message, path);
 		} else if (errno == EACCES) {
-			printf("[Error] %s file '%s' is not accessible\n", message, path);
+			Message_Print("[Error] %s file '%s' is not accessible\n", message, path);
 		}
 		return FAILURE;
 	}
 	/* Check if path is a directory */
 	if (st.st_mode & S_IFDIR) {
-		printf("[Error] %s file '%s' is a directory\n", message, path);
+		Message_Print("[Error] %s file '%s' is a directory\n", message, path);
 	}
 	/* Check read access. */
 	if ((fp = fopen(path, "r")) == NULL) { /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
-		printf("[Error] %s file '%s' is not readable (access denied)\n", message, path);
+		Message_Print("[Error] %s file '%s' is not readable (access denied)\n", message, path);
 		return FAILURE;
 	}
 	fclose(fp);
@@ -51,9 +50,9 @@ bool check_files_permission(char* message, char* path, bool path_is_input) {
 	if (path_is_input == false) {
 		if ((fp = fopen(path, "w")) == NULL) { /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
 			if (errno == EACCES) {
-				printf("[Error] %s file '%s' is not writable (access denied)\n", message, path);
+				Message_Print("[Error] %s file '%s' is not writable (access denied)\n", message, path);
 			} else if (errno == EROFS) {
-				printf("[Error] %s file '%s' is not writable (read-only filesystem)\n", message, path);
+				Message_Print("[Error] %s file '%s' is not writable (read-only filesystem)\n", message, path);
 			}
 			return FAILURE;
 		}
@@ -62,6 +61,49 @@ bool check_files_permission(char* message, char* path, bool path_is_input) {
 	return SUCCESS;
 }
 
+/* Decode the program region of the memory image (up to and including the HALT command) into 'program'
+ * The number of commands before the HALT is stored at 'instructionNum', 'program' must be freed by the caller
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool decode_program(const stMemory* pMemory, command_row_t** program, unsigned int* instructionNum) {
+	command_row_t* decoded = (command_row_t*) malloc(sizeof(command_row_t) * (MEMORY_SIZE + 1));
+	command_row_t* shrinked = NULL;
+	uint32_t capacity = MEMORY_SIZE + 1, i = 0;
+	if (!decoded) {
+		Message_Print("[Fatal] Program decoding malloc failed\n");
+		return FAILURE;
+	}
+	for (i=0; i<pMemory->size; ++i) {
+		if (i == capacity) { /* Only a program that does not halt early grows past the default memory size */
+			capacity = (pMemory->size / 2 < capacity) ? (pMemory->size + 1) : (capacity * 2);
+			shrinked = (command_row_t*) realloc(decoded, sizeof(command_row_t) * capacity);
+			if (!shrinked) {
+				Message_Print("[Fatal] Program decoding malloc failed\n");
+				free(decoded);
+				return FAILURE;
+			}
+			decoded = shrinked;
+		}
+		if (parse_opcode(Memory_Read(pMemory, i), &decoded[i]) == FAILURE) {
+			Message_Print("[Error] memin line %u holds an invalid command '%08x'\n", i, Memory_Read(pMemory, i));
+			free(decoded);
+			return FAILURE;
+		}
+		if (decoded[i].opcode == OPCODE_HALT) {
+			break;
+		}
+	}
+	shrinked = (command_row_t*) realloc(decoded, sizeof(command_row_t) * (i + 1)); /* Keep only the program region */
+	*instructionNum = i;
+	*program = (shrinked != NULL) ? shrinked : decoded;
+	return SUCCESS;
+}
+
+/* Encode the command into its memory line, The inverse of parse_opcode() */
+uint32_t encode_command(const command_row_t* command) {
+	return ((uint32_t)command->opcode << 24) | ((uint32_t)command->dst << 20) | ((uint32_t)command->src0 << 16) |
+		((uint32_t)command->src1 << 12) | ((uint32_t)command->imm & 0xFFF);
+}
+
 /* This function used to convert int SAFELY to register enum as defined in reg_t */
 /* The function must received a valid int between 0 to 15 */
 reg_t int_to_reg(int input) {
@@ -89,99 +131,219 @@ reg_t int_to_reg(int input) {
 /* Load the configuration from file 'path', validate and parse it
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
 bool load_cfg(char* path, configuration* config) {
-	FILE* fp;
-	char* line = NULL;
-	char* trimed_line = (char*) malloc(sizeof(char) * 4096);
-	size_t len = 0;
-	ssize_t read = 0;
-	uint16_t readed_config = 0; /* Start as '0000 0000 0000 0000' */
-	if (!trimed_line) {
-		printf("[Fatal] Configuration parsing malloc failed\n");
-		return EXIT_FAILURE;
-	}
-	fp = fopen(path, "r"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
-	if (fp == NULL) {
-		perror("fopen");
-		free(trimed_line);
+	static const char* names[NUM_OF_CONFIGURATION_NUMS] = CONFIGURATION_NUM_NAMES;
+	char text[CONFIGURATION_LINE_MAX_LENGTH + 1];
+	char* pData = NULL;
+	char* pLine = NULL;
+	char* pLineEnd = NULL;
+	char* pValue = NULL;
+	size_t length = 0, textLength = 0;
+	uint32_t readed_config = 0; /* Bit i is set once the numeric field i was read, CONFIGURATION_TRACE_UNIT_BIT for trace_unit */
+	unsigned int field = 0;
+	bool isValid = true;
+	if (map_file(path, &pData, &length) == FAILURE) {
 		return FAILURE;
 	}
-	while ((read = getline(&line, &len, fp)) != -1) {
-		trim(line, &trimed_line);
-		if (((readed_config & 0x1) == 0) && (validate_conf_num("add_nr_units=%hu", trimed_line, &(config->add_nr_units)) == SUCCESS)) { /* add_nr_units */
-			readed_config = readed_config | 0x1; /* Turn bit '0000 0000 0000 0001' on */
-		} else if (((readed_config & 0x2) == 0) && (validate_conf_num("sub_nr_units=%hu", trimed_line, &(config->sub_nr_units)) == SUCCESS)) { /* sub_nr_units */
-			readed_config = readed_config | 0x2; /* Turn bit '0000 0000 0000 0010' on */
-		} else if (((readed_config & 0x4) == 0) && (validate_conf_num("mul_nr_units=%hu", trimed_line, &(config->mul_nr_units)) == SUCCESS)) { /* mul_nr_units */
-			readed_config = readed_config | 0x4; /* Turn bit '0000 0000 0000 0100' on */
-		} else if (((readed_config & 0x8) == 0) && (validate_conf_num("div_nr_units=%hu", trimed_line, &(config->div_nr_units)) == SUCCESS)) { /* div_nr_units */
-			readed_config = readed_config | 0x8; /* Turn bit '0000 0000 0000 1000' on */
-		} else if (((readed_config & 0x10) == 0) && (validate_conf_num("ld_nr_units=%hu", trimed_line, &(config->ld_nr_units)) == SUCCESS)) { /* ld_nr_units */
-			readed_config = readed_config | 0x10; /* Turn bit '0000 0000 0001 0000' on */
-		} else if (((readed_config & 0x20) == 0) && (validate_conf_num("st_nr_units=%hu", trimed_line, &(config->st_nr_units)) == SUCCESS)) { /* st_nr_units */
-			readed_config = readed_config | 0x20; /* Turn bit '0000 0000 0010 0000' on */
-		} else if (((readed_config & 0x40) == 0) && (validate_conf_num("add_delay=%hu", trimed_line, &(config->add_delay)) == SUCCESS)) { /* add_delay */
-			readed_config = readed_config | 0x40; /* Turn bit '0000 0000 0100 0000' on */
-		} else if (((readed_config & 0x80) == 0) && (validate_conf_num("sub_delay=%hu", trimed_line, &(config->sub_delay)) == SUCCESS)) { /* sub_delay */
-			readed_config = readed_config | 0x80; /* Turn bit '0000 0000 1000 0000' on */
-		} else if (((readed_config & 0x100) == 0) && (validate_conf_num("mul_delay=%hu", trimed_line, &(config->mul_delay)) == SUCCESS)) { /* mul_delay */
-			readed_config = readed_config | 0x100; /* Turn bit '0000 0001 0000 0000' on */
-		} else if (((readed_config & 0x200) == 0) && (validate_conf_num("div_delay=%hu", trimed_line, &(config->div_delay)) == SUCCESS)) { /* div_delay */
-			readed_config = readed_config | 0x200; /* Turn bit '0000 0010 0000 0000' on */
-		} else if (((readed_config & 0x400) == 0) && (validate_conf_num("ld_delay=%hu", trimed_line, &(config->ld_delay)) == SUCCESS)) { /* ld_delay */
-			readed_config = readed_config | 0x400; /* Turn bit '0000 0100 0000 0000' on */
-		} else if (((readed_config & 0x800) == 0) && (validate_conf_num("st_delay=%hu", trimed_line, &(config->st_delay)) == SUCCESS)) { /* st_delay */
-			readed_config = readed_config | 0x800; /* Turn bit '0000 1000 0000 0000' on */
-		} else if (((readed_config & 0x1000) == 0) && (validate_conf_str("trace_unit", trimed_line, config->trace_unit) == SUCCESS)) { /* trace_unit */
-			readed_config = readed_config | 0x1000; /* Turn bit '0001 0000 0000 0000' on */
-		} else if (strlen(trimed_line) > 0) {
-			printf("[Error] Configuration file have invalid lines\n");
-			free(line);
-			free(trimed_line);
-			fclose(fp);
-			return FAILURE;
+	for (field=NUM_OF_REQUIRED_CONFIGURATION_NUMS; field<NUM_OF_CONFIGURATION_NUMS; ++field) { /* Optional, A cfg file without them models a single issue machine of blocking FUs */
+		(&(config->add_nr_units))[field] = DEFAULT_OPTIONAL_CFG_VALUE; /* The numeric fields are consecutive */
+	}
+	for (pLine=pData; isValid && (pLine<pData+length); pLine=pLineEnd+1) {
+		pLineEnd = memchr(pLine, '\n', (size_t)(pData + length - pLine));
+		if (pLineEnd == NULL) { /* The last line has no '\n' */
+			pLineEnd = pData + length;
+		}
+		textLength = compact_cfg_line(pLine, pLineEnd, text);
+		if (textLength == 0) { /* Empty lines are skipped */
+			continue;
+		}
+		pValue = memchr(text, '=', textLength);
+		isValid = (textLength <= CONFIGURATION_LINE_MAX_LENGTH) && (pValue != NULL);
+		if (!isValid) {
+			break;
+		}
+		*(pValue++) = '\0'; /* 'text' is the key and 'pValue' the value */
+		field = 0;
+		while ((field < NUM_OF_CONFIGURATION_NUMS) && (strcmp(names[field], text) != 0)) {
+			++field;
+		}
+		if (field < NUM_OF_CONFIGURATION_NUMS) {
+			isValid = ((readed_config & (1u << field)) == 0) && (parse_cfg_num(pValue, &((&(config->add_nr_units))[field])) == SUCCESS);
+			readed_config |= (1u << field);
+		} else if (strcmp(text, "trace_unit") == 0) {
+			isValid = ((readed_config & CONFIGURATION_TRACE_UNIT_BIT) == 0) && (*pValue != '\0') &&
+				  (strlen(pValue) <= CONFIGURATION_STR_MAX_LENGTH);
+			if (isValid) {
+				memcpy(config->trace_unit, pValue, strlen(pValue) + 1);
+			}
+			readed_config |= CONFIGURATION_TRACE_UNIT_BIT;
+		} else {
+			isValid = false;
 		}
 	}
-	if (line) {
-		free(line);
+	unmap_file(pData, length);
+	if (!isValid) {
+		Message_Print("[Error] Configuration file have invalid lines\n");
+		return FAILURE;
 	}
-	free(trimed_line);
-	fclose(fp);
-	if (readed_config == 0x1FFF) { /* Found all the configuration line '0001 1111 1111 1111' */
-		return SUCCESS;
-	} else {
-		printf("[Error] Configuration file have missing lines\n");
+	if ((readed_config & CONFIGURATION_REQUIRED_BITS) != CONFIGURATION_REQUIRED_BITS) {
+		Message_Print("[Error] Configuration file have missing lines\n");
 		return FAILURE;
 	}
+	return SUCCESS;
 }
 
 /* Load the memory image from file 'path'
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool load_memin(char* path, unsigned int memory[]) {
+bool load_memin(char* path, stMemory* pMemory) {
+	char* pData = NULL;
+	char* pLine = NULL;
+	char* pLineEnd = NULL;
+	size_t length = 0;
+	uint32_t line_count = 0;
+	unsigned int word = 0;
+	bool isValid = true;
+	if (map_file(path, &pData, &length) == FAILURE) {
+		return FAILURE;
+	}
+	for (pLine=pData; isValid && (pLine<pData+length); pLine=pLineEnd+1) {
+		pLineEnd = memchr(pLine, '\n', (size_t)(pData + length - pLine));
+		if (pLineEnd == NULL) { /* The last line has no '\n' */
+			pLineEnd = pData + length;
+		}
+		if (line_count == pMemory->size) {
+			Message_Print("[Error] memin has more than %u lines\n", pMemory->size);
+			isValid = false;
+		} else {
+			isValid = parse_memin_line(pLine, (size_t)(pLineEnd - pLine), &word);
+			Memory_Write(pMemory, line_count, word);
+			line_count++;
+		}
+	}
+	unmap_file(pData, length);
+	return (isValid && !pMemory->failed) ? SUCCESS : FAILURE;
+}
+
+/* Apply the sparse memout file 'path' (written with an initial image) on top of that initial image in 'memory'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool load_sparse_memout(char* path, stMemory* pMemory) {
+	char* pData = NULL;
+	char* pLine = NULL;
+	char* pLineEnd = NULL;
+	size_t length = 0;
+	unsigned int address = pMemory->size, word = 0, line_count = 0;
+	bool isValid = true;
+	if (map_file(path, &pData, &length) == FAILURE) {
+		return FAILURE;
+	}
+	for (pLine=pData; isValid && (pLine<pData+length); pLine=pLineEnd+1) {
+		pLineEnd = memchr(pLine, '\n', (size_t)(pData + length - pLine));
+		if (pLineEnd == NULL) { /* The last line has no '\n' */
+			pLineEnd = pData + length;
+		}
+		line_count++;
+		if (pLine[0] == '@') { /* The start of a range of changed words */
+			isValid = parse_memin_line(pLine + 1, (size_t)(pLineEnd - pLine - 1), &address);
+		} else if (address < pMemory->size) {
+			isValid = parse_memin_line(pLine, (size_t)(pLineEnd - pLine), &word);
+			Memory_Write(pMemory, address, word);
+			address++;
+		} else {
+			isValid = false;
+		}
+		if (!isValid) {
+			Message_Print("[Error] Sparse memout line %u is invalid or out of the memory\n", line_count);
+		}
+	}
+	unmap_file(pData, length);
+	return (isValid && !pMemory->failed) ? SUCCESS : FAILURE;
+}
+
+/* Map the whole input file 'path' read only, The file must be released with unmap_file()
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool map_file(char* path, char** ppData, size_t* pLength) {
+#ifndef _WIN32
+	struct stat st;
+	int fd = open(path, O_RDONLY); /* Upon successful completion open() return a file descriptor. Otherwise, -1 is returned and errno is set to indicate the error. */
+	if (fd < 0) {
+		perror("open");
+		return FAILURE;
+	}
+	if (fstat(fd, &st) != 0) {
+		perror("fstat");
+		close(fd);
+		return FAILURE;
+	}
+	*ppData = NULL;
+	*pLength = (size_t)st.st_size;
+	if (*pLength != 0) { /* An empty file can not be mapped */
+		*ppData = mmap(NULL, *pLength, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (*ppData == MAP_FAILED) {
+			perror("mmap");
+			*ppData = NULL;
+			close(fd);
+			return FAILURE;
+		}
+	}
+	close(fd); /* The mapping stays valid after the descriptor is closed */
+	return SUCCESS;
+#else
 	FILE* fp;
-	int line_count = 0;
-	unsigned int temp = 0;
-	char* line = NULL;
-	size_t len = 0;
-	ssize_t read = 0;
-	fp = fopen(path, "r"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
+	long length = 0;
+	fp = fopen(path, "rb"); /* No mmap() on Windows, read the whole file instead */
 	if (fp == NULL) {
 		perror("fopen");
 		return FAILURE;
 	}
-	while ((read = getline(&line, &len, fp)) != -1) {
-		if (sscanf(line, "%x", &temp) != 1) {
-			free(line);
-			fclose(fp);
-			return FAILURE;
-		}
-		memory[line_count] = temp;
-		line_count++;
+	if ((fseek(fp, 0, SEEK_END) != 0) || ((length = ftell(fp)) < 0) || (fseek(fp, 0, SEEK_SET) != 0)) {
+		perror("fseek");
+		fclose(fp);
+		return FAILURE;
 	}
-	if (line) {
-		free(line);
+	*pLength = (size_t)length;
+	*ppData = (char*) malloc(*pLength + 1);
+	if (!*ppData || (fread(*ppData, 1, *pLength, fp) != *pLength)) {
+		Message_Print("[Error] Reading '%s' failed\n", path);
+		free(*ppData);
+		fclose(fp);
+		return FAILURE;
 	}
 	fclose(fp);
 	return SUCCESS;
+#endif /* _WIN32 */
+}
+
+/* Create (or truncate) the output file 'path' and keep it open in 'pOut', 'message' names the file in errors
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool open_output_file(char* message, char* path, stOutBuffer* pOut) {
+	if (OutBuf_Open(pOut, path) == SUCCESS) {
+		return SUCCESS;
+	}
+	if (errno == EACCES) {
+		Message_Print("[Error] %s file '%s' is not writable (access denied)\n", message, path);
+	} else if (errno == EROFS) {
+		Message_Print("[Error] %s file '%s' is not writable (read-only filesystem)\n", message, path);
+	} else if (errno == EISDIR) {
+		Message_Print("[Error] %s file '%s' is a directory\n", message, path);
+	} else {
+		Message_Print("[Error] %s file '%s' can not be opened (%s)\n", message, path, strerror(errno));
+	}
+	return FAILURE;
+}
+
+/* Parse the --memory-size value 'str' into 'pSize', It must be a number of words between MEMORY_SIZE and MAX_MEMORY_SIZE
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool parse_memory_size(const char* str, uint32_t* pSize) {
+	unsigned long size = 0;
+	int consumed = 0;
+	if ((sscanf(str, "%lu%n", &size, &consumed) != 1) || (str[consumed] != '\0')) {
+		return FAILURE;
+	}
+	if ((size < MEMORY_SIZE) || (MAX_MEMORY_SIZE < size)) {
+		Message_Print("[Error] The memory size must be between %u and %u words\n", MEMORY_SIZE, MAX_MEMORY_SIZE);
+		return FAILURE;
+	}
+	*pSize = (uint32_t)size;
+	return SUCCESS;
 }
 
 /* This function parse a memory line into a valid command
@@ -209,6 +371,7 @@ bool parse_opcode(unsigned int memory_line, command_row_t* command) {
 			break;
 		case 6: command->opcode = OPCODE_HALT;
 			break;
+		default:
 			return FAILURE;
 	}
 	/* Bits 20-23 represent the DST register */
@@ -231,6 +394,21 @@ bool parse_opcode(unsigned int memory_line, command_row_t* command) {
 	command->src1 = int_to_reg(temp);
 	/* Bits 0-11 represent the IMM number */
 	command->imm = (unsigned short int)(memory_line & 0xFFF);
+	/* Registers the command reads and writes */
+	switch (command->opcode) {
+		case OPCODE_LD: command->srcMask = 0;
+			command->dstMask = (uint16_t)(1 << command->dst);
+			break;
+		case OPCODE_ST: command->srcMask = (uint16_t)(1 << command->src1);
+			command->dstMask = 0;
+			break;
+		case OPCODE_HALT: command->srcMask = 0;
+			command->dstMask = 0;
+			break;
+		default: command->srcMask = (uint16_t)((1 << command->src0) | (1 << command->src1));
+			command->dstMask = (uint16_t)(1 << command->dst);
+			break;
+	}
 	return SUCCESS;
 }
 
@@ -239,154 +417,282 @@ void print_usage() {
 	printf("Usage: sim <cfg> <memin> <memout> <regout> <traceinst> <traceunit>\n");
 	printf("Simulator for floating point processor using the scoreboard algorithm.\n\n");
 	printf("Mandatory arguments:\n");
-	printf("  cfg                  Input file, Path to the file containing the configuration.\n");
+	printf("  cfg                  Input file, Path to the file containing the configuration, The optional fetch_width\n");
+	printf("                       and issue_width (default %d, up to %d) fetch and issue that many commands every cycle.\n", DEFAULT_OPTIONAL_CFG_VALUE, INSTRUCTION_QUEUE_LENGTH);
+	printf("                       The optional <type>_pipeline_depth (default %d, up to %d) lets every unit of the type\n", DEFAULT_OPTIONAL_CFG_VALUE, MAX_PIPELINE_DEPTH);
+	printf("                       hold that many commands, Slot S of unit ADD0 is named ADD0.S, <type>_init_interval\n");
+	printf("                       (default %d) is the minimum number of cycles between two commands starting on a unit.\n", DEFAULT_OPTIONAL_CFG_VALUE);
 	printf("  memin                Input file, Path to the file containing the memory image.\n");
 	printf("  memout               Output file, Where to store the memory image when the program end.\n");
 	printf("  regout               Output file, Where to store the registry image when the program end.\n");
 	printf("  traceinst            Output file, Where to store the list of executed commands.\n");
 	printf("  traceunit            Output file, Where to store the list of trace_unit busy clock cycles.\n");
+	printf("                       trace_unit is one FU name, a comma separated list of names or ALL, The busy\n");
+	printf("                       cycles of all the listed units go to one file, ordered by cycle then by unit.\n\n");
+	printf("Options:\n");
+	printf("  --binary-trace       Write traceinst and traceunit in the compact binary trace format (also in batch mode),\n");
+	printf("                       'trace2text <binary trace> <text trace>' converts them back to text.\n");
+	printf("  --sparse-memout      Write only the memout words that differ from memin (also in batch mode),\n");
+	printf("                       'memexpand <memin> <sparse memout> <memout>' expands it back to the full image.\n");
+	printf("  --memory-size N      Memory size in words, Default and minimum is %u, Maximum is %u (also in batch and\n", MEMORY_SIZE, MAX_MEMORY_SIZE);
+	printf("                       sweep mode), Memory pages are allocated on their first write.\n");
+	printf("  --functional         Run the program without timing, in program order, Only memout and regout are written\n");
+	printf("                       (also in batch mode).\n");
+	printf("  --self-check         Run the timing free engine after the simulation and report every register and memory\n");
+	printf("                       difference between the two (also in batch mode).\n");
+	printf("  --sample-period N    Sampled run (also in batch mode), Simulate --detail-window instructions in detail at\n");
+	printf("  --detail-window N    the start of every N instructions and execute the rest without timing, The total\n");
+	printf("                       cycles are extrapolated with a 95%% confidence interval, No trace files are written.\n");
+	printf("  --stats PATH         Write a JSON report of the run to PATH, The issue stalls (structural, WAW, empty queue),\n");
+	printf("                       the RAW, WAR and common data bus stalls, the queue occupancy histogram, the IPC and\n");
+	printf("                       the busy and idle cycles of every FU.\n");
+	printf("  --probes PATH        Attach the probes to the run and write the number of events of every probe to PATH\n");
+	printf("                       (JSON), The counts are checked against the issued commands, Needs a build with\n");
+	printf("                       'make PROBES=RING' or 'make PROBES=CALLBACK'.\n");
+	printf("  --tomasulo           Run the Tomasulo engine instead of the scoreboard (also in batch and sweep mode), The\n");
+	printf("                       destination registers are renamed so there are no WAW or WAR stalls, Every FU is a\n");
+	printf("                       reservation station and one result is written every cycle on the common data bus.\n");
+	printf("                       Same input and output files, traceunit shows the reservation stations.\n");
+	printf("  --checkpoint PATH    Save the whole simulator state to PATH when the cycle given by --checkpoint-cycle\n");
+	printf("                       starts (default 0), The run then continues to the end as usual.\n\n");
+	printf("Restore mode: sim --restore <checkpoint> <memout> <regout> <traceinst> <traceunit>\n");
+	printf("  checkpoint           Input file, Written by --checkpoint, It holds the cfg, the memory and the program.\n");
+	printf("  traceunit            Must hold the traceunit written by the run that saved the checkpoint, It is cut back\n");
+	printf("                       to the checkpoint cycle and continued, Copy it first to branch many runs from it.\n");
+	printf("                       The trace format and the memory size are the ones of the checkpoint.\n\n");
+	printf("Batch mode: sim --batch <manifest> [--threads <N>]\n");
+	printf("  manifest             Input file, Every line holds the six paths of one run (in the order above).\n");
+	printf("                       Empty lines and lines starting with '#' are skipped.\n");
+	printf("  --threads N          Number of worker threads, Default is the number of online CPUs.\n");
+	printf("\nSweep mode: sim --sweep <sweep> <memin> <csv> [--threads <N>]\n");
+	printf("  sweep                Input file, Every line is '<field> = <values>' for one numeric cfg field, Values is\n");
+	printf("                       a comma separated list of numbers and 'first-last[:step]' ranges, The optional cfg\n");
+	printf("                       fields may be left out.\n");
+	printf("  csv                  Output file, The total cycles and FU utilization of every configuration.\n");
 }
 
-/* Write the memory image to file 'path'
+/* Release a file mapped by map_file() */
+void unmap_file(char* pData, size_t length) {
+#ifndef _WIN32
+	if (pData != NULL) {
+		munmap(pData, length);
+	}
+#else
+	(void)length;
+	free(pData);
+#endif /* _WIN32 */
+}
+
+/* Write the memory image to the open memout file, The image covers the default memory size and every word written
+ * beyond it, If 'pInitial' is not NULL only the words that differ from it are written, as '@<address>' lines
+ * that start every range of changed words (the $readmemh format)
+ * The file is closed when the function returns
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool write_memout(char* path, unsigned int memory[]) {
-	FILE* fp;
-	int line_count = 0;
-	fp = fopen(path, "w"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
-	if (fp == NULL) {
-		perror("fopen");
-		return FAILURE;
-	}
-	for (line_count=0; line_count<MEMORY_SIZE; ++line_count) {
-		fprintf(fp, "%.8x\n", memory[line_count]);
+bool write_memout(stOutBuffer* pOut, const stMemory* pMemory, const stMemory* pInitial) {
+	const uint32_t* pPage = NULL;
+	const uint32_t* pInitialPage = NULL;
+	char* pLine = NULL;
+	uint32_t imageSize = (pMemory->usedSize < MEMORY_SIZE) ? MEMORY_SIZE : pMemory->usedSize;
+	uint32_t address = 0, value = 0;
+	bool inRange = false;
+	for (address=0; address<imageSize; ++address) {
+		if ((address & (MEMORY_PAGE_SIZE - 1)) == 0) { /* The first word of a page */
+			pPage = Memory_GetPage(pMemory, address >> MEMORY_PAGE_BITS);
+			pInitialPage = (pInitial != NULL) ? Memory_GetPage(pInitial, address >> MEMORY_PAGE_BITS) : NULL;
+			if ((pInitial != NULL) && (pPage == NULL) && (pInitialPage == NULL)) { /* Nothing changed in a page that was never written */
+				inRange = false;
+				address += MEMORY_PAGE_SIZE - 1;
+				continue;
+			}
+		}
+		value = (pPage != NULL) ? pPage[address & (MEMORY_PAGE_SIZE - 1)] : 0;
+		if ((pInitial != NULL) && (value == ((pInitialPage != NULL) ? pInitialPage[address & (MEMORY_PAGE_SIZE - 1)] : 0))) {
+			inRange = false;
+			continue;
+		}
+		pLine = OutBuf_Reserve(pOut);
+		if ((pInitial != NULL) && !inRange) {
+			*pLine++ = '@';
+			pLine = OutBuf_FormatHex8(pLine, address);
+			*pLine++ = '\n';
+			inRange = true;
+		}
+		pLine = OutBuf_FormatHex8(pLine, value);
+		*pLine++ = '\n';
+		OutBuf_Commit(pOut, pLine);
 	}
-	fclose(fp);
-	return SUCCESS;
+	return OutBuf_Close(pOut);
 }
 
-/* Write the register content to file 'path'
+/* Write the event counts of the probe session to the open probes file as one JSON object, With the number of
+ * events the full ring dropped, The file is closed when the function returns
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool write_regout(char* path, float registers[]) {
-	FILE* fp;
+bool write_probes(stOutBuffer* pOut, const stProbeSession* pSession) {
+	char* pLine = NULL;
+	int probe = 0;
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, OutBuf_FormatString(pLine, "{\n\t\"events\": {"));
+	for (probe=0; probe<NUM_OF_PROBES; ++probe) {
+		pLine = OutBuf_Reserve(pOut);
+		OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "%s\n\t\t\"%s\": %llu", (probe == 0) ? "" : ",", Probe_Name(probe), (unsigned long long)pSession->counts[probe]));
+	}
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "\n\t},\n\t\"dropped\": %llu\n}\n", (unsigned long long)pSession->probes.dropped));
+	return OutBuf_Close(pOut);
+}
+
+/* Write the register content to the open regout file, The file is closed when the function returns
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool write_regout(stOutBuffer* pOut, float registers[]) {
+	char* pLine = NULL;
 	int line_count = 0;
-	fp = fopen(path, "w"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
-	if (fp == NULL) {
-		perror("fopen");
-		return FAILURE;
-	}
-	for (line_count=0; line_count<NUM_OF_REGISTERS; ++line_count) {
-		fprintf(fp, "%.6f\n", registers[line_count]);
+	for (line_count=0; line_count<NUM_OF_REGISTERS; ++line_count) { /* Few lines, "%.6f" rounding is left to snprintf() */
+		pLine = OutBuf_Reserve(pOut);
+		OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "%.6f\n", registers[line_count]));
 	}
-	fclose(fp);
-	return SUCCESS;
+	return OutBuf_Close(pOut);
 }
 
-/* Write the traceinst fields to file 'path'
+/* Write the stall statistics of the finished run to the open stats file as one JSON object, With the IPC and the
+ * busy and idle cycles of every FU, The file is closed when the function returns
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool write_traceinst(char* path, stScoreboardCPU* a_pThis) {
-	FILE* fp;
-	command_row_t cmd;
-	int line_count = 0;
-	fp = fopen(path, "w"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
-	if (fp == NULL) {
-		perror("fopen");
+bool write_stats(stOutBuffer* pOut, const stScoreboardCPU* a_pThis) {
+	const char* stallNames[NUM_OF_ISSUE_STALLS] = { "halt_drain", "queue_empty", "structural", "waw" }; /* Indexed by ISSUE_STALL_*_IDX */
+	const stStats* pStats = a_pThis->pStats;
+	const stFunctionalUnit* pFU = NULL;
+	char* pLine = NULL;
+	unsigned int i = 0;
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "{\n\t\"cycles\": %u,\n\t\"instructions\": %u,\n\t\"ipc\": %.6f,\n",
+		a_pThis->cycle, a_pThis->lastIssuedPC, (double)a_pThis->lastIssuedPC / a_pThis->cycle));
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, OutBuf_FormatString(pLine, "\t\"issue_stalls\": {"));
+	for (i=0; i<NUM_OF_ISSUE_STALLS; ++i) {
+		pLine = OutBuf_Reserve(pOut);
+		OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "%s\n\t\t\"%s\": %llu", (i == 0) ? "" : ",", stallNames[i], (unsigned long long)pStats->issueStalls[i]));
+	}
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, OutBuf_FormatString(pLine, "\n\t},\n"));
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "\t\"fetch_stalls\": {\"queue_full\": %llu},\n", (unsigned long long)pStats->fetchStalls));
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "\t\"read_operands_stalls\": {\"raw\": %llu},\n", (unsigned long long)pStats->rawStalls));
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "\t\"write_result_stalls\": {\"war\": %llu, \"cdb\": %llu},\n",
+		(unsigned long long)pStats->warStalls, (unsigned long long)pStats->cdbStalls));
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, OutBuf_FormatString(pLine, "\t\"queue_occupancy\": ["));
+	for (i=0; i<=INSTRUCTION_QUEUE_LENGTH; ++i) { /* Cycles that ended with i queued commands */
+		pLine = OutBuf_Reserve(pOut);
+		OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "%s%llu", (i == 0) ? "" : ", ", (unsigned long long)pStats->queueOccupancy[i]));
+	}
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, OutBuf_FormatString(pLine, "],\n\t\"functional_units\": ["));
+	for (i=0; i<a_pThis->numOfFUs; ++i) {
+		pFU = &(a_pThis->pFUs[i]);
+		pLine = OutBuf_Reserve(pOut);
+		OutBuf_Commit(pOut, pLine + snprintf(pLine, OUTPUT_LINE_MAX_LENGTH, "%s\n\t\t{\"name\": \"%s\", \"busy_cycles\": %u, \"idle_cycles\": %u}",
+			(i == 0) ? "" : ",", pFU->fuName, pFU->busyCycles, a_pThis->cycle - pFU->busyCycles));
+	}
+	pLine = OutBuf_Reserve(pOut);
+	OutBuf_Commit(pOut, OutBuf_FormatString(pLine, (a_pThis->numOfFUs == 0) ? "]\n}\n" : "\n\t]\n}\n"));
+	return OutBuf_Close(pOut);
+}
+
+/* Write the traceinst fields to the open traceinst file, In the binary trace format if 'binary' is set
+ * The file is closed when the function returns
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool write_traceinst(stOutBuffer* pOut, stScoreboardCPU* a_pThis, bool binary) {
+	stTraceFile trace;
+	uint32_t stages[WRITE_RESULT_STAGE_IDX + 1];
+	unsigned int line_count = 0;
+	int stage = 0;
+	if (Trace_Open(&trace, pOut, binary, BIN_TRACE_INST_MAGIC, a_pThis->FUsNum, a_pThis->FUsDepth) == FAILURE) {
+		OutBuf_Close(pOut);
 		return FAILURE;
 	}
-	for (line_count=0; line_count<MEMORY_SIZE; ++line_count) {
-		parse_opcode(a_pThis->pMemory[line_count], &cmd);
-		if (cmd.opcode == OPCODE_HALT) {
-			break;
+	for (line_count=0; line_count<a_pThis->instructionNum; ++line_count) {
+		for (stage=ISSUE_STAGE_IDX; stage<=WRITE_RESULT_STAGE_IDX; ++stage) {
+			stages[stage] = a_pThis->instructionStatus[stage][line_count];
 		}
-		fprintf(fp, "%08x %d %s %d %d %d %d\n",
-							a_pThis->pMemory[line_count],
-							line_count,
-							a_pThis->instructionFUs[line_count],
-							a_pThis->instructionStatus[0][line_count],
-							a_pThis->instructionStatus[1][line_count],
-							a_pThis->instructionStatus[2][line_count],
-							a_pThis->instructionStatus[3][line_count]
-			);
-	}
-	fclose(fp);
-	return SUCCESS;
-}
-
-//Function that returns the number of instruction from the memory beginning until the HALT command
-unsigned int get_instructionNum(unsigned int memory[])
-{
-	command_row_t currCmd;
-	unsigned int i;
-	for (i  = 0; i < MEMORY_SIZE; i++)
-	{
-		parse_opcode(memory[i], &currCmd);
-		if (currCmd.opcode == OPCODE_HALT)
-			break;
+		Trace_AddInst(&trace, Memory_Read(a_pThis->pMemory, line_count), line_count, a_pThis->instructionFUs[line_count], stages);
 	}
-	return i;
+	Trace_Close(&trace);
+	return OutBuf_Close(pOut);
 }
 
 /************************************************************************/
 /*	Private functions declaration					*/
 /************************************************************************/
-/* Function to remove all spaces and tabs from a given string
- * Code is based on: https://stackoverflow.com/a/1514740 */
-void trim(char* src, char** buff) {
-	if (4096 < strlen(src)) {
-		(*buff)[0] = '\0';
-		return;
-	}
-	char* current = src;
-	unsigned int sizeBuff = 0, i = 0;
-	current[strcspn(current, "\r\n")] = '\0'; /* Remove \r and \r\n */
-	sizeBuff = strlen(current);
-	if (sizeBuff < 1) {
-		(*buff)[0] = '\0';
-		return;
-	}
-	while ((*current != '\0') && (i<sizeBuff-1)) {
-		if ((*current != ' ') && (*current != '\t')) {
-			(*buff)[i++] = *current;
+/* Copy the cfg line from 'pLine' up to 'pLineEnd' to 'text' without its spaces and tabs, The line ends at the first
+ * '\r' as well, 'text' holds up to CONFIGURATION_LINE_MAX_LENGTH characters and its terminator
+ * The length of the copied text is returned, CONFIGURATION_LINE_MAX_LENGTH + 1 if the line does not fit */
+size_t compact_cfg_line(const char* pLine, const char* pLineEnd, char* text) {
+	size_t length = 0;
+	for (; (pLine < pLineEnd) && (*pLine != '\r'); ++pLine) {
+		if ((*pLine == ' ') || (*pLine == '\t')) {
+			continue;
+		}
+		if (CONFIGURATION_LINE_MAX_LENGTH <= length) {
+			return CONFIGURATION_LINE_MAX_LENGTH + 1;
 		}
-		++current;
+		text[length++] = *pLine;
 	}
-	(*buff)[i] = '\0';
+	text[length] = '\0';
+	return length;
 }
-/* The function recieved a configuration line with 'unsigned short int',
- * if its a valid configuration line, the parsed value will be stored at 'output_value'
+
+/* Parse the decimal value of a numeric cfg field into 'pValue', It must be between 0 and CONFIGURATION_INT_MAX_VALUE
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool validate_conf_num(char* property_name, char* input_line, unsigned short int* output_value) {
-	unsigned short int extracted_value = 0;
-	/* Parse the input line */
-	if ((input_line == NULL) || (strlen(input_line) < 1)) {
-		return FAILURE;
-	}
-	if (sscanf(input_line, property_name, &extracted_value) != 1) { /* sscanf() Return the number of input items successfully matched and assigned */
+bool parse_cfg_num(const char* str, unsigned short int* pValue) {
+	unsigned int value = 0;
+	if (*str == '\0') {
 		return FAILURE;
 	}
-	/* Check max value */
-	if (CONFIGURATION_INT_MAX_VALUE < extracted_value) {
-		return FAILURE;
+	for (; *str != '\0'; ++str) {
+		if ((*str < '0') || ('9' < *str)) {
+			return FAILURE;
+		}
+		value = value * 10 + (unsigned int)(*str - '0');
+		if (CONFIGURATION_INT_MAX_VALUE < value) {
+			return FAILURE;
+		}
 	}
-	/* Save the property value */
-	*output_value = extracted_value;
+	*pValue = (unsigned short int)value;
 	return SUCCESS;
 }
 
-/* The function recieved a configuration line with 'char*',
- * if its a valid configuration line, the parsed value will be stored at 'output_value'
+/* Parse a memin line of 'length' characters (without the '\n') into 'value'
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool validate_conf_str(char* property_name, char* input_line, char output_value[]) {
-	char format[32] = {0};
-	char extracted_value[CONFIGURATION_STR_MAX_LENGTH+1] = {0};
-	/* Parse the input line */
-	if (snprintf(format, sizeof(format), "%s=%%%ds", property_name, CONFIGURATION_STR_MAX_LENGTH) < 5) { /* snprintf() Upon successful return the number of characters printed */
-		return FAILURE;
+bool parse_memin_line(const char* line, size_t length, unsigned int* value) {
+	static const int8_t hexValues[256] = { /* -1 for characters that are not hex digits */
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+		-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+	};
+	char fallback[64] = {0};
+	unsigned int result = 0;
+	int invalid = 0, i = 0;
+	if ((length == 8) || ((length == 9) && (line[8] == '\r'))) { /* The format the simulator writes, 8 hex digits */
+		for (i=0; i<8; ++i) { /* No branches, an invalid digit sets the sign bit of 'invalid' */
+			invalid |= hexValues[(unsigned char)line[i]];
+			result = (result << 4) | (unsigned int)(hexValues[(unsigned char)line[i]] & 0xF);
+		}
+		if (0 <= invalid) {
+			*value = result;
+			return SUCCESS;
+		}
 	}
-	if (sscanf(input_line, format, extracted_value) != 1) { /* sscanf() Return the number of input items successfully matched and assigned */
+	/* Any other line is parsed like it always was, with "%x" */
+	memcpy(fallback, line, (length < sizeof(fallback)) ? length : (sizeof(fallback) - 1));
+	if (sscanf(fallback, "%x", value) != 1) {
 		return FAILURE;
 	}
-	/* Save the property value */
-	strncpy(output_value, extracted_value, CONFIGURATION_STR_MAX_LENGTH+1);
 	return SUCCESS;
 }
 
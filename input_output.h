@@ -2,10 +2,20 @@
 #define INPUT_OUTPUT_H_
 
 #include "defines.h"
+#include "memory.h"
+#include "message.h"
+#include "probe.h"
+#include "trace.h"
 
 /* The function check 'path' for existance and optional check for read and/or write permission
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
 bool check_files_permission(char *, char *, bool);
+/* Decode the program region of the memory image (up to and including the HALT command) into 'program'
+ * The number of commands before the HALT is stored at 'instructionNum', 'program' must be freed by the caller
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool decode_program(const stMemory *, command_row_t **, unsigned int *);
+/* Encode the command into its memory line, The inverse of parse_opcode() */
+uint32_t encode_command(const command_row_t *);
 /* This function used to convert int SAFELY to register enum as defined in reg_t */
 /* The function must received a valid int between 0 to 15 */
 reg_t int_to_reg(int input);
@@ -14,22 +24,46 @@ reg_t int_to_reg(int input);
 bool load_cfg(char *, configuration *);
 /* Load the memory image from file 'path'
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool load_memin(char *, unsigned int []);
+bool load_memin(char *, stMemory *);
+/* Apply the sparse memout file 'path' (written with an initial image) on top of that initial image in 'memory'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool load_sparse_memout(char *, stMemory *);
+/* Map the whole input file 'path' read only, The file must be released with unmap_file()
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool map_file(char *, char **, size_t *);
+/* Create (or truncate) the output file 'path' and keep it open in 'pOut', 'message' names the file in errors
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool open_output_file(char *, char *, stOutBuffer *);
+/* Parse the --memory-size value 'str' into 'pSize', It must be a number of words between MEMORY_SIZE and MAX_MEMORY_SIZE
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool parse_memory_size(const char *, uint32_t *);
 /* This function parse a memory line into a valid command
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
 bool parse_opcode(unsigned int, command_row_t *);
 /* Print program usage message */
 void print_usage();
-/* Write the memory image to file 'path'
+/* Release a file mapped by map_file() */
+void unmap_file(char *, size_t);
+/* Write the memory image to the open memout file, The image covers the default memory size and every word written
+ * beyond it, If 'pInitial' is not NULL only the words that differ from it are written, as '@<address>' lines
+ * that start every range of changed words (the $readmemh format)
+ * The file is closed when the function returns
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool write_memout(stOutBuffer *, const stMemory *, const stMemory *);
+/* Write the event counts of the probe session to the open probes file as one JSON object, With the number of
+ * events the full ring dropped, The file is closed when the function returns
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool write_probes(stOutBuffer *, const stProbeSession *);
+/* Write the register content to the open regout file, The file is closed when the function returns
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool write_memout(char *, unsigned int []);
-/* Write the register content to file 'path'
+bool write_regout(stOutBuffer *, float []);
+/* Write the stall statistics of the finished run to the open stats file as one JSON object, With the IPC and the
+ * busy and idle cycles of every FU, The file is closed when the function returns
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool write_regout(char *, float []);
-/* Write the traceinst fields to file 'path'
+bool write_stats(stOutBuffer *, const stScoreboardCPU *);
+/* Write the traceinst fields to the open traceinst file, In the binary trace format if 'binary' is set
+ * The file is closed when the function returns
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool write_traceinst(char *, stScoreboardCPU *);
-//Function that returns the number of instruction from the memory beginning until the HALT command
-unsigned int get_instructionNum(unsigned int []);
+bool write_traceinst(stOutBuffer *, stScoreboardCPU *, bool);
 
 #endif /* INPUT_OUTPUT_H_ */
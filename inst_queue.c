@@ -3,32 +3,27 @@
 /************************************************************************/
 /*	Private functions prototypes					*/
 /************************************************************************/
-bool InstQ_Dequeue(InstQ *, command_row_t *);
 bool InstQ_IsEmpty(InstQ *);
 
 /************************************************************************/
 /*	Public functions declaration					*/
 /************************************************************************/
-InstQ* InstQ_ConstructQueue(int limit) {
-	InstQ* queue = (InstQ*) malloc(sizeof(InstQ));
-	if (!queue) {
-		return NULL;
+bool InstQ_ConstructQueue(InstQ* pQueue, int limit) {
+	if ((pQueue == NULL) || (limit < 1) || (INSTRUCTION_QUEUE_LENGTH < limit)) {
+		return FAILURE;
 	}
-	queue->limit = limit;
-	queue->size = 0;
-	queue->head = NULL;
-	queue->tail = NULL;
-	return queue;
+	pQueue->limit = limit;
+	pQueue->size = 0;
+	pQueue->head = 0;
+	return SUCCESS;
 }
 
 void InstQ_DestructQueue(InstQ* pQueue) {
-	command_row_t Instr;
-	while (!InstQ_IsEmpty(pQueue)) {
-		if (InstQ_Dequeue(pQueue, &Instr) == FAILURE) {
-			printf("[Error] Failed to dequeue\n");
-		}
+	if (pQueue == NULL) {
+		return;
 	}
-	free(pQueue);
+	pQueue->size = 0;
+	pQueue->head = 0;
 }
 
 bool InstQ_Enqueue(InstQ* pQueue, command_row_t Instr) {
@@ -36,21 +31,8 @@ bool InstQ_Enqueue(InstQ* pQueue, command_row_t Instr) {
 	if ( (pQueue == NULL) || (pQueue->size >= pQueue->limit)) {
 		return FAILURE;
 	}
-	NODE* item = (NODE*) malloc(sizeof(NODE));
-	if (!item) {
-		return FAILURE;
-	}
-	item->m_Instr = Instr;
-	item->prev = NULL;
-	if (pQueue->size == 0) {
-		/* If the queue is empty */
-		pQueue->head = item;
-		pQueue->tail = item;
-	} else {
-		/* Else, Add item to the end of the queue */
-		pQueue->tail->prev = item;
-		pQueue->tail = item;
-	}
+	/* Add item to the end of the queue */
+	pQueue->m_Instr[(pQueue->head + pQueue->size) % INSTRUCTION_QUEUE_LENGTH] = Instr;
 	pQueue->size++;
 	return SUCCESS;
 }
@@ -59,8 +41,7 @@ bool InstQ_Peek(InstQ* pQueue, command_row_t* pInstr) {
 	if (InstQ_IsEmpty(pQueue)) {
 		return FAILURE;
 	}
-	NODE* item = pQueue->head;
-	*pInstr = item->m_Instr;
+	*pInstr = pQueue->m_Instr[pQueue->head];
 	return SUCCESS;
 }
 
@@ -68,9 +49,7 @@ bool InstQ_Pop(InstQ* pQueue) {
 	if (InstQ_IsEmpty(pQueue)) { /* The queue is empty or bad param */
 		return FAILURE;
 	}
-	NODE* item = pQueue->head;
-	pQueue->head = (pQueue->head)->prev;
-	free(item);
+	pQueue->head = (pQueue->head + 1) % INSTRUCTION_QUEUE_LENGTH;
 	pQueue->size--;
 	return SUCCESS;
 }
@@ -78,18 +57,6 @@ bool InstQ_Pop(InstQ* pQueue) {
 /************************************************************************/
 /*	Private functions declaration					*/
 /************************************************************************/
-bool InstQ_Dequeue(InstQ* pQueue, command_row_t* pInstr) {
-	if (InstQ_IsEmpty(pQueue)) { /* The queue is empty or bad param */
-		return FAILURE;
-	}
-	NODE* item = pQueue->head;
-	*pInstr = item->m_Instr;
-	pQueue->head = (pQueue->head)->prev;
-	free(item);
-	pQueue->size--;
-	return SUCCESS;
-}
-
 bool InstQ_IsEmpty(InstQ* pQueue) {
 	if (pQueue == NULL) {
 		return false;
@@ -3,7 +3,7 @@
 
 #include "defines.h"
 
-InstQ* InstQ_ConstructQueue(int);
+bool InstQ_ConstructQueue(InstQ *, int);
 void InstQ_DestructQueue(InstQ *);
 bool InstQ_Enqueue(InstQ *, command_row_t);
 bool InstQ_Peek(InstQ *, command_row_t *);
@@ -0,0 +1,108 @@
+#include "memory.h"
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Copy the memory 'pSrc' into the uninitialized memory 'pDst', Only the allocated pages are copied
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Memory_Copy(stMemory* pDst, const stMemory* pSrc) {
+	uint32_t i = 0;
+	if (Memory_Init(pDst, pSrc->size) == FAILURE) {
+		return FAILURE;
+	}
+	pDst->usedSize = pSrc->usedSize;
+	for (i=0; i<pSrc->pagesNum; ++i) {
+		if (pSrc->pPages[i] != NULL) {
+			pDst->pPages[i] = (uint32_t*) malloc(MEMORY_PAGE_SIZE * sizeof(uint32_t));
+			if (!pDst->pPages[i]) {
+				Message_Print("[Fatal] Memory page malloc failed\n");
+				Memory_Destroy(pDst);
+				return FAILURE;
+			}
+			memcpy(pDst->pPages[i], pSrc->pPages[i], MEMORY_PAGE_SIZE * sizeof(uint32_t));
+		}
+	}
+	return SUCCESS;
+}
+
+/* Free all the pages of the memory */
+void Memory_Destroy(stMemory* pMemory) {
+	uint32_t i = 0;
+	if (pMemory->pPages == NULL) {
+		return;
+	}
+	for (i=0; i<pMemory->pagesNum; ++i) {
+		free(pMemory->pPages[i]);
+	}
+	free(pMemory->pPages);
+	pMemory->pPages = NULL;
+}
+
+/* Return the page 'pageIdx' of the memory, or NULL if it was never written (all its words are zero) */
+const uint32_t* Memory_GetPage(const stMemory* pMemory, uint32_t pageIdx) {
+	return pMemory->pPages[pageIdx];
+}
+
+/* Compare two memories of the same size, Return true if all their words are equal
+ * Otherwise the first address that differs is stored at 'pAddress' */
+bool Memory_IsEqual(const stMemory* pFirst, const stMemory* pSecond, uint32_t* pAddress) {
+	const uint32_t* pFirstPage = NULL;
+	const uint32_t* pSecondPage = NULL;
+	uint32_t pageIdx = 0, i = 0;
+	for (pageIdx=0; pageIdx<pFirst->pagesNum; ++pageIdx) {
+		pFirstPage = pFirst->pPages[pageIdx];
+		pSecondPage = pSecond->pPages[pageIdx];
+		if ((pFirstPage == NULL) && (pSecondPage == NULL)) {
+			continue;
+		}
+		for (i=0; i<MEMORY_PAGE_SIZE; ++i) {
+			if (((pFirstPage != NULL) ? pFirstPage[i] : 0) != ((pSecondPage != NULL) ? pSecondPage[i] : 0)) {
+				*pAddress = (pageIdx << MEMORY_PAGE_BITS) + i;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/* Initialize an empty memory of 'size' words, No page is allocated until it is written
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Memory_Init(stMemory* pMemory, uint32_t size) {
+	pMemory->size = size;
+	pMemory->usedSize = 0;
+	pMemory->pagesNum = (size + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE;
+	pMemory->failed = false;
+	pMemory->pPages = (uint32_t**) calloc(pMemory->pagesNum, sizeof(uint32_t*));
+	if (!pMemory->pPages) {
+		Message_Print("[Fatal] Memory page table malloc failed\n");
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+/* Return the word at 'address', The address must be smaller than the memory size */
+uint32_t Memory_Read(const stMemory* pMemory, uint32_t address) {
+	const uint32_t* pPage = pMemory->pPages[address >> MEMORY_PAGE_BITS];
+	return (pPage != NULL) ? pPage[address & (MEMORY_PAGE_SIZE - 1)] : 0;
+}
+
+/* Write 'value' to the word at 'address', The address must be smaller than the memory size
+ * A failed page malloc marks the memory as failed and the value is lost */
+void Memory_Write(stMemory* pMemory, uint32_t address, uint32_t value) {
+	uint32_t** ppPage = &(pMemory->pPages[address >> MEMORY_PAGE_BITS]);
+	if (pMemory->usedSize <= address) {
+		pMemory->usedSize = address + 1;
+	}
+	if (*ppPage == NULL) {
+		if (value == 0) { /* A missing page reads as zero, no need to allocate it */
+			return;
+		}
+		*ppPage = (uint32_t*) calloc(MEMORY_PAGE_SIZE, sizeof(uint32_t));
+		if (*ppPage == NULL) {
+			Message_Print("[Fatal] Memory page malloc failed\n");
+			pMemory->failed = true;
+			return;
+		}
+	}
+	(*ppPage)[address & (MEMORY_PAGE_SIZE - 1)] = value;
+}
@@ -0,0 +1,26 @@
+#ifndef MEMORY_H_
+#define MEMORY_H_
+
+#include "defines.h"
+#include "message.h"
+
+/* Copy the memory 'pSrc' into the uninitialized memory 'pDst', Only the allocated pages are copied
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Memory_Copy(stMemory *, const stMemory *);
+/* Free all the pages of the memory */
+void Memory_Destroy(stMemory *);
+/* Return the page 'pageIdx' of the memory, or NULL if it was never written (all its words are zero) */
+const uint32_t* Memory_GetPage(const stMemory *, uint32_t);
+/* Compare two memories of the same size, Return true if all their words are equal
+ * Otherwise the first address that differs is stored at 'pAddress' */
+bool Memory_IsEqual(const stMemory *, const stMemory *, uint32_t *);
+/* Initialize an empty memory of 'size' words, No page is allocated until it is written
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Memory_Init(stMemory *, uint32_t);
+/* Return the word at 'address', The address must be smaller than the memory size */
+uint32_t Memory_Read(const stMemory *, uint32_t);
+/* Write 'value' to the word at 'address', The address must be smaller than the memory size
+ * A failed page malloc marks the memory as failed and the value is lost */
+void Memory_Write(stMemory *, uint32_t, uint32_t);
+
+#endif /* MEMORY_H_ */
@@ -0,0 +1,67 @@
+#include "message.h"
+
+#ifndef _WIN32
+static pthread_key_t	jobLineKey; /* The manifest line of the job of every thread, Stored in the pointer itself */
+static pthread_once_t	jobLineKeyOnce = PTHREAD_ONCE_INIT;
+#else
+static unsigned int	jobLine = 0; /* No thread pool on Windows, The jobs run one after the other */
+#endif /* _WIN32 */
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Return the manifest line of the job the calling thread runs, 0 if none */
+unsigned int Message_GetJobLine();
+#ifndef _WIN32
+/* Create the thread specific key of the job line, Called once */
+void Message_InitKey();
+#endif /* _WIN32 */
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Print the printf() style message to the standard output in one write, Prefixed with the manifest line of the job
+ * the calling thread runs (see Message_SetJobLine()) so the errors of parallel jobs can be told apart */
+void Message_Print(const char* format, ...) {
+	char message[MESSAGE_MAX_LENGTH];
+	unsigned int line = Message_GetJobLine();
+	int length = 0;
+	va_list args;
+	if (line != 0) {
+		length = snprintf(message, sizeof(message), "Manifest line %u: ", line);
+	}
+	va_start(args, format);
+	vsnprintf(message + length, sizeof(message) - length, format, args);
+	va_end(args);
+	fputs(message, stdout); /* A single write keeps the messages of parallel jobs whole */
+}
+
+/* Set the manifest line of the job the calling thread runs from now on, 0 when it runs no batch job */
+void Message_SetJobLine(unsigned int line) {
+#ifndef _WIN32
+	pthread_once(&jobLineKeyOnce, Message_InitKey);
+	pthread_setspecific(jobLineKey, (void*)(uintptr_t)line);
+#else
+	jobLine = line;
+#endif /* _WIN32 */
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Return the manifest line of the job the calling thread runs, 0 if none */
+unsigned int Message_GetJobLine() {
+#ifndef _WIN32
+	pthread_once(&jobLineKeyOnce, Message_InitKey);
+	return (unsigned int)(uintptr_t)pthread_getspecific(jobLineKey);
+#else
+	return jobLine;
+#endif /* _WIN32 */
+}
+
+#ifndef _WIN32
+/* Create the thread specific key of the job line, Called once */
+void Message_InitKey() {
+	pthread_key_create(&jobLineKey, NULL);
+}
+#endif /* _WIN32 */
@@ -0,0 +1,12 @@
+#ifndef MESSAGE_H_
+#define MESSAGE_H_
+
+#include "defines.h"
+
+/* Print the printf() style message to the standard output in one write, Prefixed with the manifest line of the job
+ * the calling thread runs (see Message_SetJobLine()) so the errors of parallel jobs can be told apart */
+void Message_Print(const char *, ...);
+/* Set the manifest line of the job the calling thread runs from now on, 0 when it runs no batch job */
+void Message_SetJobLine(unsigned int);
+
+#endif /* MESSAGE_H_ */
@@ -0,0 +1,164 @@
+#include "out_buffer.h"
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Write the whole buffer to the file, A failed write marks the file as failed and drops the buffer */
+void OutBuf_Flush(stOutBuffer *);
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Flush and close the output file, The function return FAILURE (false) if any write to the file failed */
+bool OutBuf_Close(stOutBuffer* pOut) {
+	OutBuf_Flush(pOut);
+	if (close(pOut->fd) != 0) { /* Upon successful completion close() return 0. Otherwise, -1 is returned and errno is set to indicate the error. */
+		perror("close");
+		pOut->failed = true;
+	}
+	free(pOut->pBuffer);
+	pOut->pBuffer = NULL;
+	return (pOut->failed) ? FAILURE : SUCCESS;
+}
+
+/* Append the text written since OutBuf_Reserve() up to 'pEnd' to the file */
+void OutBuf_Commit(stOutBuffer* pOut, char* pEnd) {
+	pOut->used = (size_t)(pEnd - pOut->pBuffer);
+}
+
+/* Write the number at 'pDst' as 8 lower case hex digits ("%08x") and return the end of the written text */
+char* OutBuf_FormatHex8(char* pDst, uint32_t value) {
+	static const char digits[] = "0123456789abcdef";
+	int i = 0;
+	for (i=7; 0<=i; --i) {
+		pDst[i] = digits[value & 0xF];
+		value = value >> 4;
+	}
+	return pDst + 8;
+}
+
+/* Write the signed decimal of the number at 'pDst' and return the end of the written text */
+char* OutBuf_FormatInt(char* pDst, int32_t value) {
+	if (value < 0) {
+		*pDst++ = '-';
+		return OutBuf_FormatUInt(pDst, (uint32_t)0 - (uint32_t)value);
+	}
+	return OutBuf_FormatUInt(pDst, (uint32_t)value);
+}
+
+/* Copy the string (without its terminator) to 'pDst' and return the end of the written text */
+char* OutBuf_FormatString(char* pDst, const char* str) {
+	while (*str != '\0') {
+		*pDst++ = *str++;
+	}
+	return pDst;
+}
+
+/* Write the unsigned decimal of the number at 'pDst' and return the end of the written text */
+char* OutBuf_FormatUInt(char* pDst, uint32_t value) {
+	char digits[10]; /* 4294967295 */
+	int len = 0;
+	do {
+		digits[len++] = (char)('0' + (value % 10));
+		value = value / 10;
+	} while (value != 0);
+	while (len > 0) {
+		*pDst++ = digits[--len];
+	}
+	return pDst;
+}
+
+/* Create (or truncate) the output file 'path', On failure errno tells why and nothing is printed
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool OutBuf_Open(stOutBuffer* pOut, char* path) {
+	pOut->used = 0;
+	pOut->failed = false;
+	pOut->pBuffer = (char*) malloc(OUTPUT_BUFFER_SIZE);
+	if (!pOut->pBuffer) {
+		errno = ENOMEM;
+		return FAILURE;
+	}
+	pOut->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666); /* Upon successful completion open() return a file descriptor. Otherwise, -1 is returned and errno is set to indicate the error. */
+	if (pOut->fd < 0) {
+		free(pOut->pBuffer);
+		pOut->pBuffer = NULL;
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+/* Return where to write the next line, There is room for at least OUTPUT_LINE_MAX_LENGTH bytes
+ * The line is appended to the file by passing its end to OutBuf_Commit() */
+char* OutBuf_Reserve(stOutBuffer* pOut) {
+	if (OUTPUT_BUFFER_SIZE - pOut->used < OUTPUT_LINE_MAX_LENGTH) {
+		OutBuf_Flush(pOut);
+	}
+	return pOut->pBuffer + pOut->used;
+}
+
+/* Reopen the existing output file 'path' to append after its first 'offset' bytes, Anything after them is dropped
+ * On failure errno tells why (EINVAL if the file is shorter than 'offset') and nothing is printed
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool OutBuf_Resume(stOutBuffer* pOut, char* path, uint64_t offset) {
+	struct stat st;
+	int savedErrno = 0;
+	pOut->used = 0;
+	pOut->failed = false;
+	pOut->pBuffer = (char*) malloc(OUTPUT_BUFFER_SIZE);
+	if (!pOut->pBuffer) {
+		errno = ENOMEM;
+		return FAILURE;
+	}
+	pOut->fd = open(path, O_WRONLY); /* Upon successful completion open() return a file descriptor. Otherwise, -1 is returned and errno is set to indicate the error. */
+	if (pOut->fd >= 0) {
+		if (fstat(pOut->fd, &st) != 0) {
+			savedErrno = errno;
+		} else if ((uint64_t)st.st_size < offset) {
+			savedErrno = EINVAL;
+		} else if ((ftruncate(pOut->fd, (off_t)offset) != 0) || (lseek(pOut->fd, (off_t)offset, SEEK_SET) < 0)) {
+			savedErrno = errno;
+		} else {
+			return SUCCESS;
+		}
+		close(pOut->fd);
+		errno = savedErrno;
+	}
+	free(pOut->pBuffer);
+	pOut->pBuffer = NULL;
+	return FAILURE;
+}
+
+/* Return the size of the file including the buffered text, The buffer is flushed first */
+uint64_t OutBuf_Tell(stOutBuffer* pOut) {
+	off_t offset = 0;
+	OutBuf_Flush(pOut);
+	offset = lseek(pOut->fd, 0, SEEK_CUR); /* Upon successful completion lseek() return the offset. Otherwise, -1 is returned and errno is set to indicate the error. */
+	if (offset < 0) {
+		perror("lseek");
+		pOut->failed = true;
+		return 0;
+	}
+	return (uint64_t)offset;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Write the whole buffer to the file, A failed write marks the file as failed and drops the buffer */
+void OutBuf_Flush(stOutBuffer* pOut) {
+	size_t written = 0;
+	ssize_t result = 0;
+	while ((written < pOut->used) && !pOut->failed) {
+		result = write(pOut->fd, pOut->pBuffer + written, pOut->used - written); /* write() may write less than requested */
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("write");
+			pOut->failed = true;
+		} else {
+			written += (size_t)result;
+		}
+	}
+	pOut->used = 0;
+}
@@ -0,0 +1,31 @@
+#ifndef OUT_BUFFER_H_
+#define OUT_BUFFER_H_
+
+#include "defines.h"
+
+/* Flush and close the output file, The function return FAILURE (false) if any write to the file failed */
+bool OutBuf_Close(stOutBuffer *);
+/* Append the text written since OutBuf_Reserve() up to 'pEnd' to the file */
+void OutBuf_Commit(stOutBuffer *, char *);
+/* Write the number at 'pDst' as 8 lower case hex digits ("%08x") and return the end of the written text */
+char* OutBuf_FormatHex8(char *, uint32_t);
+/* Write the signed decimal of the number at 'pDst' and return the end of the written text */
+char* OutBuf_FormatInt(char *, int32_t);
+/* Copy the string (without its terminator) to 'pDst' and return the end of the written text */
+char* OutBuf_FormatString(char *, const char *);
+/* Write the unsigned decimal of the number at 'pDst' and return the end of the written text */
+char* OutBuf_FormatUInt(char *, uint32_t);
+/* Create (or truncate) the output file 'path', On failure errno tells why and nothing is printed
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool OutBuf_Open(stOutBuffer *, char *);
+/* Return where to write the next line, There is room for at least OUTPUT_LINE_MAX_LENGTH bytes
+ * The line is appended to the file by passing its end to OutBuf_Commit() */
+char* OutBuf_Reserve(stOutBuffer *);
+/* Reopen the existing output file 'path' to append after its first 'offset' bytes, Anything after them is dropped
+ * On failure errno tells why (EINVAL if the file is shorter than 'offset') and nothing is printed
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool OutBuf_Resume(stOutBuffer *, char *, uint64_t);
+/* Return the size of the file including the buffered text, The buffer is flushed first */
+uint64_t OutBuf_Tell(stOutBuffer *);
+
+#endif /* OUT_BUFFER_H_ */
@@ -0,0 +1,230 @@
+#include "probe.h"
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Count one event of the probe session 'pContext', The callback of every probe with PROBE_MODE_CALLBACK */
+void Probe_CountEvent(void *, int, uint32_t, int, int);
+/* Move the events of the ring of the probe session into its counts, The number of events moved is returned */
+uint32_t Probe_DrainRing(stProbeSession *);
+/* Read a ring index stored by the other side, Every event before it is visible after the read */
+uint32_t Probe_LoadIndex(const uint32_t *);
+/* The body of the reader thread of the probe session 'pContext', Drains the ring until the session is stopped */
+void* Probe_ReadRing(void *);
+/* Store a ring index for the other side, Every event before it is visible before the store */
+void Probe_StoreIndex(uint32_t *, uint32_t);
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Check the event counts of the probe session against the run that issued 'issued' commands, Every issued command
+ * is issued, reads its operands and writes its result once and every fetched command but the HALT is issued
+ * When events were dropped the counts can only be lower
+ * The function return SUCCESS (true) if the counts match and FAILURE (false) otherwise */
+bool Probe_CheckCounts(const stProbeSession* pSession, uint32_t issued) {
+	const uint64_t* counts = pSession->counts;
+	uint64_t expected[NUM_OF_PROBES] = {0};
+	bool isValid = true;
+	int probe = 0;
+	expected[PROBE_FETCH_IDX] = (uint64_t)issued + 1;
+	expected[PROBE_ISSUE_IDX] = issued;
+	expected[PROBE_READ_OPERANDS_IDX] = issued;
+	expected[PROBE_WRITEBACK_IDX] = issued;
+	for (probe=0; probe<NUM_OF_PROBES; ++probe) {
+		if (expected[probe] == 0) { /* The stalls have no count to check against */
+			continue;
+		}
+		if ((counts[probe] > expected[probe]) || ((pSession->probes.dropped == 0) && (counts[probe] != expected[probe]))) {
+			Message_Print("[Error] The probes counted %llu %s events, Expected %llu for %u issued commands\n",
+				(unsigned long long)counts[probe], Probe_Name(probe), (unsigned long long)expected[probe], issued);
+			isValid = false;
+		}
+	}
+	if (counts[PROBE_EXEC_DONE_IDX] > issued) {
+		Message_Print("[Error] The probes counted %llu %s events for %u issued commands\n",
+			(unsigned long long)counts[PROBE_EXEC_DONE_IDX], Probe_Name(PROBE_EXEC_DONE_IDX), issued);
+		isValid = false;
+	}
+	return isValid;
+}
+
+/* Release the ring buffer of the probes */
+void Probe_Destroy(stProbes* pProbes) {
+	free(pProbes->pRing);
+	pProbes->pRing = NULL;
+	pProbes->ringSize = 0;
+}
+
+/* Detach the probe session from the finished run, With PROBE_MODE_RING the reader thread drains the rest of the
+ * ring and exits, The ring is released */
+void Probe_EndSession(stProbeSession* pSession) {
+#if PROBE_MODE == PROBE_MODE_RING
+	Probe_StoreIndex(&(pSession->isStopped), 1);
+#ifndef _WIN32
+	pthread_join(pSession->reader, NULL);
+#endif /* _WIN32 */
+	while (Probe_DrainRing(pSession) != 0) { /* Whatever the reader did not see before it stopped */
+	}
+#endif /* PROBE_MODE */
+	Probe_Destroy(&(pSession->probes));
+}
+
+/* Report one event to the probes, Appended to the ring buffer with PROBE_MODE_RING (dropped if it is full) or
+ * passed to the callback of the probe with PROBE_MODE_CALLBACK */
+void Probe_Fire(stProbes* pProbes, int probe, uint32_t cycle, int pc, int fuId) {
+#if PROBE_MODE == PROBE_MODE_RING
+	uint32_t head = pProbes->ringHead;
+	stProbeEvent* pEvent = NULL;
+	if ((uint32_t)(head - Probe_LoadIndex(&(pProbes->ringTail))) == pProbes->ringSize) { /* Full, or no ring at all */
+		pProbes->dropped++;
+		return;
+	}
+	pEvent = &(pProbes->pRing[head & (pProbes->ringSize - 1)]);
+	pEvent->cycle = cycle;
+	pEvent->pc = pc;
+	pEvent->fuId = (int16_t)fuId;
+	pEvent->probe = (uint8_t)probe;
+	Probe_StoreIndex(&(pProbes->ringHead), head + 1); /* Publish the event */
+#elif PROBE_MODE == PROBE_MODE_CALLBACK
+	if (pProbes->callbacks[probe] != NULL) {
+		pProbes->callbacks[probe](pProbes->pContext, probe, cycle, pc, fuId);
+	}
+#else
+	(void)pProbes;
+	(void)probe;
+	(void)cycle;
+	(void)pc;
+	(void)fuId;
+#endif /* PROBE_MODE */
+}
+
+/* Clear the callbacks and allocate a ring buffer of 'ringSize' events, A power of two, 0 for no ring
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Probe_Init(stProbes* pProbes, uint32_t ringSize) {
+	memset(pProbes, 0, sizeof(stProbes));
+	if ((ringSize & (ringSize - 1)) != 0) {
+		Message_Print("[Error] The probe ring size %u is not a power of two\n", ringSize);
+		return FAILURE;
+	}
+	if (ringSize != 0) {
+		pProbes->pRing = malloc(ringSize * sizeof(stProbeEvent));
+		if (pProbes->pRing == NULL) {
+			Message_Print("[Fatal] malloc failed\n");
+			return FAILURE;
+		}
+		pProbes->ringSize = ringSize;
+	}
+	return SUCCESS;
+}
+
+/* Return the name of the PROBE_*_IDX probe */
+const char* Probe_Name(int probe) {
+	static const char* names[NUM_OF_PROBES] = PROBE_NAMES;
+	if ((probe < 0) || (NUM_OF_PROBES <= probe)) {
+		return "unknown";
+	}
+	return names[probe];
+}
+
+/* Move up to 'maxEvents' of the oldest events of the ring buffer into 'pEvents', May run on another thread than
+ * the simulation, The number of events moved is returned */
+uint32_t Probe_RingRead(stProbes* pProbes, stProbeEvent* pEvents, uint32_t maxEvents) {
+	uint32_t tail = pProbes->ringTail;
+	uint32_t count = Probe_LoadIndex(&(pProbes->ringHead)) - tail;
+	uint32_t i = 0;
+	count = (count < maxEvents) ? count : maxEvents;
+	for (i=0; i<count; ++i) {
+		pEvents[i] = pProbes->pRing[(tail + i) & (pProbes->ringSize - 1)];
+	}
+	Probe_StoreIndex(&(pProbes->ringTail), tail + count); /* Free the slots for the simulation */
+	return count;
+}
+
+/* Start a probe session, With PROBE_MODE_CALLBACK every probe counts its events and with PROBE_MODE_RING a reader
+ * thread drains the ring into the counts, Attach it by pointing 'pProbes' of the CPU at 'probes'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise, A build with PROBE_MODE_NONE fails */
+bool Probe_StartSession(stProbeSession* pSession) {
+	int probe = 0;
+	memset(pSession->counts, 0, sizeof(pSession->counts));
+	pSession->isStopped = 0;
+#if PROBE_MODE == PROBE_MODE_RING
+	(void)probe;
+	if (Probe_Init(&(pSession->probes), PROBE_SESSION_RING_SIZE) == FAILURE) {
+		return FAILURE;
+	}
+#ifndef _WIN32
+	if (pthread_create(&(pSession->reader), NULL, Probe_ReadRing, pSession) != 0) {
+		Message_Print("[Error] Starting the probes reader thread failed\n");
+		Probe_Destroy(&(pSession->probes));
+		return FAILURE;
+	}
+#endif /* _WIN32 */
+	return SUCCESS;
+#elif PROBE_MODE == PROBE_MODE_CALLBACK
+	if (Probe_Init(&(pSession->probes), 0) == FAILURE) {
+		return FAILURE;
+	}
+	for (probe=0; probe<NUM_OF_PROBES; ++probe) {
+		pSession->probes.callbacks[probe] = Probe_CountEvent;
+	}
+	pSession->probes.pContext = pSession;
+	return SUCCESS;
+#else
+	(void)probe;
+	Message_Print("[Error] The probes are compiled out, Build with 'make PROBES=RING' or 'make PROBES=CALLBACK'\n");
+	return FAILURE;
+#endif /* PROBE_MODE */
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Count one event of the probe session 'pContext', The callback of every probe with PROBE_MODE_CALLBACK */
+void Probe_CountEvent(void* pContext, int probe, uint32_t cycle, int pc, int fuId) {
+	(void)cycle;
+	(void)pc;
+	(void)fuId;
+	((stProbeSession*)pContext)->counts[probe]++;
+}
+
+/* Move the events of the ring of the probe session into its counts, The number of events moved is returned */
+uint32_t Probe_DrainRing(stProbeSession* pSession) {
+	stProbeEvent events[PROBE_READ_BATCH];
+	uint32_t count = 0, i = 0;
+	count = Probe_RingRead(&(pSession->probes), events, PROBE_READ_BATCH);
+	for (i=0; i<count; ++i) {
+		pSession->counts[events[i].probe]++;
+	}
+	return count;
+}
+
+/* Read a ring index stored by the other side, Every event before it is visible after the read */
+uint32_t Probe_LoadIndex(const uint32_t* pIndex) {
+#if defined(__GNUC__)
+	return __atomic_load_n(pIndex, __ATOMIC_ACQUIRE);
+#else
+	return *(const volatile uint32_t*)pIndex;
+#endif
+}
+
+/* The body of the reader thread of the probe session 'pContext', Drains the ring until the session is stopped */
+void* Probe_ReadRing(void* pContext) {
+	stProbeSession* pSession = (stProbeSession*) pContext;
+	while (Probe_LoadIndex(&(pSession->isStopped)) == 0) {
+		if (Probe_DrainRing(pSession) == 0) { /* Let the simulation fill the ring */
+#ifndef _WIN32
+			sched_yield();
+#endif /* _WIN32 */
+		}
+	}
+	return NULL;
+}
+
+/* Store a ring index for the other side, Every event before it is visible before the store */
+void Probe_StoreIndex(uint32_t* pIndex, uint32_t value) {
+#if defined(__GNUC__)
+	__atomic_store_n(pIndex, value, __ATOMIC_RELEASE);
+#else
+	*(volatile uint32_t*)pIndex = value;
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef PROBE_H_
+#define PROBE_H_
+
+#include "defines.h"
+#include "message.h"
+
+/* Fire the probe 'probe' of the CPU 'pCPU' with the cycle, the PC and the FU id of the event
+ * With PROBE_MODE_NONE it compiles to nothing and its arguments are never evaluated */
+#if PROBE_MODE == PROBE_MODE_NONE
+#define PROBE(pCPU, probe, cycle, pc, fuId)	((void)0)
+#else
+#define PROBE(pCPU, probe, cycle, pc, fuId)	do { \
+		if ((pCPU)->pProbes != NULL) { \
+			Probe_Fire((pCPU)->pProbes, (probe), (cycle), (int)(pc), (int)(fuId)); \
+		} \
+	} while (0)
+#endif /* PROBE_MODE */
+
+/* Check the event counts of the probe session against the run that issued 'issued' commands, Every issued command
+ * is issued, reads its operands and writes its result once and every fetched command but the HALT is issued
+ * When events were dropped the counts can only be lower
+ * The function return SUCCESS (true) if the counts match and FAILURE (false) otherwise */
+bool Probe_CheckCounts(const stProbeSession *, uint32_t);
+/* Release the ring buffer of the probes */
+void Probe_Destroy(stProbes *);
+/* Detach the probe session from the finished run, With PROBE_MODE_RING the reader thread drains the rest of the
+ * ring and exits, The ring is released */
+void Probe_EndSession(stProbeSession *);
+/* Report one event to the probes, Appended to the ring buffer with PROBE_MODE_RING (dropped if it is full) or
+ * passed to the callback of the probe with PROBE_MODE_CALLBACK */
+void Probe_Fire(stProbes *, int, uint32_t, int, int);
+/* Clear the callbacks and allocate a ring buffer of 'ringSize' events, A power of two, 0 for no ring
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Probe_Init(stProbes *, uint32_t);
+/* Return the name of the PROBE_*_IDX probe */
+const char* Probe_Name(int);
+/* Move up to 'maxEvents' of the oldest events of the ring buffer into 'pEvents', May run on another thread than
+ * the simulation, The number of events moved is returned */
+uint32_t Probe_RingRead(stProbes *, stProbeEvent *, uint32_t);
+/* Start a probe session, With PROBE_MODE_CALLBACK every probe counts its events and with PROBE_MODE_RING a reader
+ * thread drains the ring into the counts, Attach it by pointing 'pProbes' of the CPU at 'probes'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise, A build with PROBE_MODE_NONE fails */
+bool Probe_StartSession(stProbeSession *);
+
+#endif /* PROBE_H_ */
@@ -0,0 +1,106 @@
+#include "sample.h"
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Simulate the 'length' commands at 'pWindow' in detail on the 'engine', followed by the HALT command, from a drained pipeline and the
+ * architectural state of 'registers' and the memory, The cycles it took are stored at 'pCycles' and the final
+ * registers at 'registers'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sample_runWindow(configuration *, stMemory *, command_row_t *, unsigned int, command_row_t, int, float [], uint32_t *);
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Print the estimate of a sampled run on one line */
+void sample_printResult(const stSampleResult* pResult) {
+	printf("Sampled %u instructions in %u window%s, Estimated %.0f cycles", pResult->detailedInstructions, pResult->windowsNum,
+		(pResult->windowsNum == 1) ? "" : "s", pResult->cycles);
+	if (pResult->windowsNum < 2) {
+		printf(" (no confidence interval with a single window)\n");
+	} else {
+		printf(" +- %.0f (95%% confidence)\n", pResult->confidence);
+	}
+}
+
+/* Run the program with sampling, Every 'period' instructions start with a window of 'window' instructions that is
+ * simulated in detail on the 'engine' from a drained pipeline, The rest of the period is executed by the timing free engine
+ * The total cycles are extrapolated from the cycles per instruction of the windows into 'pResult'
+ * The final registers are stored at 'registers' and the memory holds the final memory image
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sample_run(configuration* config, stMemory* pMemory, command_row_t* pProgram, unsigned int instructionNum, uint32_t period, uint32_t window, int engine, float registers[], stSampleResult* pResult) {
+	unsigned int start = 0, length = 0, skipped = 0;
+	uint32_t cycles = 0;
+	double cpi = 0, sum = 0, sumOfSquares = 0, variance = 0;
+	if (instructionNum == pMemory->size) { /* The windows end with the HALT command of the program */
+		Message_Print("[Error] The program has no HALT command\n");
+		return FAILURE;
+	}
+	pResult->windowsNum = 0;
+	pResult->detailedInstructions = 0;
+	scoreboard_resetRegisters(registers);
+	while ((start < instructionNum) || (pResult->windowsNum == 0)) { /* A program of only a HALT still has one window */
+		length = ((instructionNum - start) < window) ? (instructionNum - start) : window;
+		if ((length < window) && (pResult->windowsNum != 0)) { /* A partial last window is not representative */
+			scoreboard_fastForward(pMemory, pProgram + start, length, registers);
+			break;
+		}
+		if (sample_runWindow(config, pMemory, pProgram + start, length, pProgram[instructionNum], engine, registers, &cycles) == FAILURE) {
+			return FAILURE;
+		}
+		cpi = (length == 0) ? cycles : ((double)cycles / length);
+		sum += cpi;
+		sumOfSquares += cpi * cpi;
+		pResult->windowsNum++;
+		pResult->detailedInstructions += length;
+		start += length;
+		skipped = ((instructionNum - start) < (period - window)) ? (instructionNum - start) : (period - window);
+		scoreboard_fastForward(pMemory, pProgram + start, skipped, registers);
+		start += skipped;
+	}
+	if (pMemory->failed) { /* A store lost its value */
+		Message_Print("[Error] A memory page malloc failed\n");
+		return FAILURE;
+	}
+	/* Extrapolate the mean cycles per instruction of the windows, The interval follows their standard error */
+	if (instructionNum == 0) {
+		pResult->cycles = sum;
+		pResult->confidence = 0;
+		return SUCCESS;
+	}
+	pResult->cycles = (sum / pResult->windowsNum) * instructionNum;
+	pResult->confidence = 0;
+	if (1 < pResult->windowsNum) {
+		variance = (sumOfSquares - (sum * sum) / pResult->windowsNum) / (pResult->windowsNum - 1);
+		variance = (variance < 0) ? 0 : variance; /* Rounding of identical windows */
+		pResult->confidence = SAMPLE_CONFIDENCE_Z * sqrt(variance / pResult->windowsNum) * instructionNum;
+	}
+	return SUCCESS;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Simulate the 'length' commands at 'pWindow' in detail on the 'engine', followed by the HALT command, from a drained pipeline and the
+ * architectural state of 'registers' and the memory, The cycles it took are stored at 'pCycles' and the final
+ * registers at 'registers'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sample_runWindow(configuration* config, stMemory* pMemory, command_row_t* pWindow, unsigned int length, command_row_t haltCmd, int engine, float registers[], uint32_t* pCycles) {
+	stScoreboardCPU scoreboardCPU;
+	command_row_t nextCmd = pWindow[length];
+	bool result = SUCCESS;
+	pWindow[length] = haltCmd; /* The window is a program of its own, The command after it is restored below */
+	if (scoreboard_init(&scoreboardCPU, config, pMemory, pWindow, (int)length) == FAILURE) {
+		Message_Print("[Error] Scoreboard initialization failed\n");
+		result = FAILURE;
+	} else {
+		scoreboardCPU.engine = engine;
+		memcpy(scoreboardCPU.Register, registers, sizeof(scoreboardCPU.Register));
+		result = scoreboard_cycle(&scoreboardCPU, NULL);
+		memcpy(registers, scoreboardCPU.Register, sizeof(scoreboardCPU.Register));
+		*pCycles = scoreboardCPU.cycle;
+	}
+	scoreboard_destroy(&scoreboardCPU, NULL); /* The configuration is shared by all the windows */
+	pWindow[length] = nextCmd;
+	return result;
+}
@@ -0,0 +1,18 @@
+#ifndef SAMPLE_H_
+#define SAMPLE_H_
+
+#include "defines.h"
+#include "memory.h"
+#include "message.h"
+#include "scoreboard.h"
+
+/* Print the estimate of a sampled run on one line */
+void sample_printResult(const stSampleResult *);
+/* Run the program with sampling, Every 'period' instructions start with a window of 'window' instructions that is
+ * simulated in detail on the 'engine' from a drained pipeline, The rest of the period is executed by the timing free engine
+ * The total cycles are extrapolated from the cycles per instruction of the windows into 'pResult'
+ * The final registers are stored at 'registers' and the memory holds the final memory image
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sample_run(configuration *, stMemory *, command_row_t *, unsigned int, uint32_t, uint32_t, int, float [], stSampleResult *);
+
+#endif /* SAMPLE_H_ */
@@ -3,164 +3,367 @@
 /************************************************************************/
 /*	Private functions prototypes					*/
 /************************************************************************/
+/* This function appends the FU to the tail of the active FUs list (the list is ordered by issue) */
+void scoreboard_activateFU(stScoreboardCPU *, stFunctionalUnit *);
 /* This function checks if the simulation ended and return true if so, otherwise return false */
 bool scoreboard_checkExitConditions(stScoreboardCPU *, command_row_t);
+/* This function computes the result of one command from the registers and the memory, A store writes the memory
+ * The result is returned, It is meaningless for a store */
+float scoreboard_computeOper(stMemory *, const float [], opcode_t, reg_t, reg_t, unsigned short int);
 /* Convert Single-precision floating-point format to int
  * The integer represent the 32-bit IEEE 754 format of the decimal value */
 uint32_t scoreboard_convertFloatToInt(float);
 /* Convert int to Single-precision floating-point format
  * The integer represent the 32-bit IEEE 754 format of the decimal value */
 float scoreboard_convertIntToFloat(uint32_t);
+/* This function counts the stalls of 'count' quiet cycles, Nothing changes in them so every stall of the
+ * current state repeats in each of them */
+void scoreboard_countQuietStalls(stScoreboardCPU *, uint32_t);
+/* This function unlinks the FU from the active FUs list */
+void scoreboard_deactivateFU(stScoreboardCPU *, stFunctionalUnit *);
 /* This function performs the execution stage of the scorecoard.
  * This function is called until the execution is done */
 void scoreboard_execution(stScoreboardCPU *);
-/* This function fetches the next instruction from memory into the instruction Queue
+/* This function fetches up to 'fetch_width' instructions from memory into the instruction Queue, It stops after a HALT
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
 bool scoreboard_fetch(stScoreboardCPU *);
+/* This function returns the index of the lowest set bit, The word must not be zero */
+int scoreboard_findFirstSet(uint64_t);
+/* This function finds the traced units listed in the configuration, 'ALL' traces every FU and an empty list none
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool scoreboard_findTracedUnits(stScoreboardCPU *);
 /* This function looks for an avaliabale Functional Unit based on the opcode
  * and returns the pointer to it, If there isn't avilable FU return NULL */
 stFunctionalUnit* scoreboard_getAvailableFU(stScoreboardCPU *, opcode_t);
-/* This function Initializes the FUs and finds the traced */
-void scoreboard_initializeFUs(stScoreboardCPU *);
+/* This function returns the index of the lowest free FU in the bitmap, or -1 if all of them are busy */
+int scoreboard_getFirstFreeFU(stFreeFUs *);
+/* This function returns the ISSUE_STALL_*_IDX reason the command at the head of the queue can not be issued
+ * It must only be called when the issue of the command is known to fail */
+int scoreboard_getIssueStall(stScoreboardCPU *, const command_row_t *);
+/* This function returns the FU id the issue stall of the command waits for, The FU that writes its destination on a
+ * WAW stall and PROBE_NO_FU otherwise, It must only be called when the issue of the command is known to fail */
+int scoreboard_getIssueStallFU(stScoreboardCPU *, const command_row_t *);
+/* This function returns slot 0 of the pipelined unit of the FU, Which keeps the state of the whole unit */
+stFunctionalUnit* scoreboard_getUnit(stScoreboardCPU *, stFunctionalUnit *);
+/* This function returns how many of the following cycles are quiet, A quiet cycle is a cycle in which
+ * no FU changes its state and only the executing FUs count down their 'time_left' */
+uint32_t scoreboard_getQuietCycles(stScoreboardCPU *);
+/* This function checks if another active FU still has to read the register the FU writes (a WAR hazard)
+ * A FU reads its sources when it reads its operands, Until then 'Rj'/'Rk' tell that the source is ready, Return true if so */
+bool scoreboard_hasPendingReader(stScoreboardCPU *, const stFunctionalUnit *);
+/* This function Initializes the FUs and finds the traced
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool scoreboard_initializeFUs(stScoreboardCPU *);
+/* This function checks that the initiation interval of the unit of the FU passed since the unit last started
+ * executing a command, So the FU can start now, Return true if so, otherwise return false */
+bool scoreboard_isUnitReady(stScoreboardCPU *, stFunctionalUnit *);
 /* This function performs the issue stage of the scorecoard, Before issuing the command it checks if
  * there is no structural hazard (FU is available) and that there is no output dependency (WAW)
+ * The Tomasulo engine renames the destination instead, So only the structural hazard stalls it
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
 bool scoreboard_issue(stScoreboardCPU *, command_row_t);
-/* This function performs the operation of the Functional unit*/
+/* This function performs the operation of the Functional unit, The Tomasulo engine uses the operand values it
+ * captured instead of the registers, Which younger commands may already have written */
 void scoreboard_performOper(stScoreboardCPU *, stFunctionalUnit *);
 /* This function print to the user the received command */
 void scoreboard_printCommand(command_row_t *);
+/* This function fires the issue stall probe for every one of 'count' quiet cycles, The stall of the current
+ * state repeats in each of them */
+void scoreboard_probeQuietCycles(stScoreboardCPU *, uint32_t);
 /* This function performs the Read operands stage of the scorecoard. It checks if there is no
  * data hazards (RAW) before starting the execution (first cycle of execution is done here) */
 void scoreboard_readOperands(stScoreboardCPU *);
+/* This function marks the FU as free or busy in the free FUs bitmap of its type */
+void scoreboard_setFUFree(stScoreboardCPU *, stFunctionalUnit *, bool);
+/* This function skips over quiet cycles, Counting down the executing FUs and tracing every skipped cycle */
+void scoreboard_skipCycles(stScoreboardCPU *, uint32_t, stTraceFile *);
 /* This function performs the Write results stage of the scorecoard.
- * It stalls until there is no WAR hazrad with previous instructions */
+ * It stalls until there is no WAR hazrad with previous instructions, The Tomasulo engine has no WAR hazards
+ * but broadcasts one result every cycle on the common data bus, The oldest first */
 void scoreboard_writeResults(stScoreboardCPU *);
-/* This function writes to the traceunit file in the right format */
-void scoreboard_writeTracedUnit(stScoreboardCPU *, FILE *);
+/* This function writes the traced units state of 'count' cycles starting at the current cycle to the traceunit file */
+void scoreboard_writeTracedUnit(stScoreboardCPU *, stTraceFile *, uint32_t);
 
 /************************************************************************/
 /*	Public functions declaration					*/
 /************************************************************************/
-/* This function runs the pipeline
+/* This function runs the pipeline from the current cycle, The traced units are written to the open trace 'pTrace'
+ * unless it is NULL, A checkpoint is saved when the cycle 'checkpointCycle' starts if 'pCheckpointPath' is set
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool scoreboard_cycle(stScoreboardCPU* a_pThis, char *path) {
+bool scoreboard_cycle(stScoreboardCPU* a_pThis, stTraceFile* pTrace) {
 	command_row_t currCmd;
-	FILE* fp;
-	fp = fopen(path, "w"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
-	if (fp == NULL) {
-		perror("fopen");
-		return FAILURE;
-	}
+	uint32_t quietCycles = 0;
+	unsigned int issued = 0;
+	bool result = SUCCESS;
 	while (true) {
+		if ((a_pThis->pCheckpointPath != NULL) && (a_pThis->checkpointCycle <= a_pThis->cycle)) { /* Saved once, before anything of this cycle runs */
+			if (Checkpoint_Save(a_pThis->pCheckpointPath, a_pThis, pTrace) == FAILURE) {
+				result = FAILURE;
+				break;
+			}
+			a_pThis->pCheckpointPath = NULL;
+		}
 		if (a_pThis->halted != true) {
 			if (scoreboard_fetch(a_pThis) == FAILURE) {
-				printf("FAILURE scoreboard_fetch, currCmd.opcode=%d\n", currCmd.opcode);
-				return FAILURE;
+				Message_Print("[Error] Fetching the command at PC=%u failed\n", a_pThis->PC);
+				result = FAILURE;
+				break;
 			}
 		}
-		if (InstQ_Peek(a_pThis->InstructionQ, &currCmd) == SUCCESS) { /* Issue the next command in queue only if it's valid */
-			if (scoreboard_issue(a_pThis, currCmd) == SUCCESS) { /* If the issue was successful we pop the command from the Q */
-				if (DEBUG) {
-					scoreboard_printCommand(&(a_pThis->InstructionQ->head->m_Instr));
+		for (issued=0; issued<a_pThis->pConfiguration->issue_width; ++issued) { /* In order, The first command that can not be issued stalls the ones behind it */
+			if (InstQ_Peek(&(a_pThis->InstructionQ), &currCmd) == FAILURE) { /* Issue the next command in queue only if it's valid */
+				if (issued == 0) {
+					PROBE(a_pThis, PROBE_ISSUE_STALL_IDX, a_pThis->cycle, a_pThis->lastIssuedPC, PROBE_NO_FU);
+					if (a_pThis->pStats != NULL) {
+						a_pThis->pStats->issueStalls[ISSUE_STALL_QUEUE_EMPTY_IDX]++;
+					}
 				}
-				if (InstQ_Pop(a_pThis->InstructionQ) == FAILURE) {
-					printf("FAILURE InstQ_Pop\n");
-					return FAILURE;
+				break;
+			}
+			if (scoreboard_issue(a_pThis, currCmd) == FAILURE) {
+				if (issued == 0) { /* A cycle that issued a command is not a stall */
+					PROBE(a_pThis, PROBE_ISSUE_STALL_IDX, a_pThis->cycle, a_pThis->lastIssuedPC, scoreboard_getIssueStallFU(a_pThis, &currCmd));
+					if (a_pThis->pStats != NULL) {
+						a_pThis->pStats->issueStalls[scoreboard_getIssueStall(a_pThis, &currCmd)]++;
+					}
 				}
+				break;
+			}
+			if (DEBUG) {
+				scoreboard_printCommand(&currCmd);
+			}
+			if (InstQ_Pop(&(a_pThis->InstructionQ)) == FAILURE) { /* The issue was successful so we pop the command from the Q */
+				Message_Print("[Error] Popping the issued command from the instruction queue failed\n");
+				result = FAILURE;
+				break;
 			}
 		}
+		if (result == FAILURE) {
+			break;
+		}
 		scoreboard_readOperands(a_pThis);
 		scoreboard_execution(a_pThis);
 		scoreboard_writeResults(a_pThis);
-		scoreboard_writeTracedUnit(a_pThis, fp);
+		scoreboard_writeTracedUnit(a_pThis, pTrace, 1);
+		if (a_pThis->pStats != NULL) {
+			a_pThis->pStats->queueOccupancy[a_pThis->InstructionQ.size]++;
+		}
 		if (scoreboard_checkExitConditions(a_pThis, currCmd)) { /* scoreboard_checkExitConditions() return true if the simulation ended */
 			break;
 		} else {
+			if (EVENT_DRIVEN_CYCLES) { /* Jump straight to the cycle before the next FU state change */
+				quietCycles = scoreboard_getQuietCycles(a_pThis);
+				if ((a_pThis->pCheckpointPath != NULL) && (a_pThis->checkpointCycle <= a_pThis->cycle + quietCycles)) { /* Land exactly on the checkpoint cycle */
+					quietCycles = a_pThis->checkpointCycle - a_pThis->cycle - 1;
+				}
+				scoreboard_skipCycles(a_pThis, quietCycles, pTrace);
+			}
 			a_pThis->cycle++;
 		}
 	}
-	// closed the traceunit file
-	fclose(fp);
-	return SUCCESS;
+	if (a_pThis->pMemory->failed) { /* A store lost its value */
+		Message_Print("[Error] A memory page malloc failed at cycle %u\n", a_pThis->cycle);
+		result = FAILURE;
+	}
+	if ((result == SUCCESS) && (a_pThis->pCheckpointPath != NULL)) {
+		Message_Print("[Error] The simulation ended at cycle %u before the checkpoint cycle %u\n", a_pThis->cycle, a_pThis->checkpointCycle);
+		result = FAILURE;
+	}
+	return result;
 }
 
-/* Destroy the scoreboard */
-void scoreboard_destroy(stScoreboardCPU* a_pThis, configuration* a_pConfiguration, int a_NumberOfInstructions) {
+/* Destroy the scoreboard, The program is owned by the caller since it can be shared by many scoreboards */
+void scoreboard_destroy(stScoreboardCPU* a_pThis, configuration* a_pConfiguration) {
 	int i = 0;
-	free(a_pThis->pLD_FUs);
-	free(a_pThis->pST_FUs);
-	free(a_pThis->pADD_FUs);
-	free(a_pThis->pSUB_FUs);
-	free(a_pThis->pMULT_FUs);
-	free(a_pThis->pDIV_FUs);
+	free(a_pThis->pFUs);
 	for (i=0; i<4; ++i) {
 		free(a_pThis->instructionStatus[i]);
 	}
-	for (i=0; i<a_NumberOfInstructions; ++i) {
-		free(a_pThis->instructionFUs[i]);
-	}
-	InstQ_DestructQueue(a_pThis->InstructionQ);
+	InstQ_DestructQueue(&(a_pThis->InstructionQ));
 	free(a_pThis->instructionFUs);
+	free(a_pThis->pTracedUnits);
+	free(a_pThis->pTraceRows);
 	free(a_pConfiguration);
 }
 
-/* This function initializes the scoreboard module
+/* This function executes the 'count' commands at 'pCommands' without any timing, in program order, directly on
+ * 'registers' and the memory, It is the architectural fast forward of the timing free engines */
+void scoreboard_fastForward(stMemory* pMemory, const command_row_t* pCommands, unsigned int count, float registers[]) {
+	const command_row_t* pCmd = NULL;
+	const command_row_t* pEnd = pCommands + count;
+	float result = 0;
+	for (pCmd=pCommands; pCmd!=pEnd; ++pCmd) {
+		result = scoreboard_computeOper(pMemory, registers, pCmd->opcode, pCmd->src0, pCmd->src1, pCmd->imm);
+		if (pCmd->opcode != OPCODE_ST) { /* If it is store command we are not writing back to register */
+			registers[pCmd->dst] = result;
+		}
+	}
+}
+
+/* This function initializes the scoreboard module, The scoreboard must be destroyed even if the initialization failed
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool scoreboard_init(stScoreboardCPU* a_pThis, configuration* a_pConfiguration, uint32_t* a_pMemory, int a_NumberOfInstructions) {
+bool scoreboard_init(stScoreboardCPU* a_pThis, configuration* a_pConfiguration, stMemory* a_pMemory, command_row_t* a_pProgram, int a_NumberOfInstructions) {
 	size_t i = 0;
 	a_pThis->pConfiguration = a_pConfiguration;
 	a_pThis->pMemory = a_pMemory;
+	a_pThis->pProgram = a_pProgram;
+	a_pThis->instructionNum = a_NumberOfInstructions;
 	a_pThis->PC = 0;
 	a_pThis->cycle = 1; /* we start from cycle No. 1 */
 	a_pThis->lastIssuedPC = 0;
-	a_pThis->InstructionQ = InstQ_ConstructQueue(INSTRUCTION_QUEUE_LENGTH);
-	a_pThis->pTracedUnit = NULL;
+	a_pThis->pFUs = NULL;
+	a_pThis->instructionFUs = NULL;
+	for (i=0; i<4; ++i) {
+		a_pThis->instructionStatus[i] = NULL;
+	}
+	if (InstQ_ConstructQueue(&(a_pThis->InstructionQ), INSTRUCTION_QUEUE_LENGTH) == FAILURE) {
+		return FAILURE;
+	}
+	a_pThis->pTracedUnits = NULL;
+	a_pThis->pTraceRows = NULL;
+	a_pThis->tracedUnitsNum = 0;
+	a_pThis->pCheckpointPath = NULL;
+	a_pThis->checkpointCycle = 0;
+	a_pThis->pStats = NULL;
+	a_pThis->pProbes = NULL;
 	a_pThis->halted = false;
-	scoreboard_initializeFUs(a_pThis);
-	if (a_pThis->pTracedUnit == NULL) {
-		printf("[Error] Did not found the requested traced unit\n");
+	a_pThis->engine = ENGINE_SCOREBOARD; /* The caller may switch to ENGINE_TOMASULO before the first cycle */
+	if ((a_pConfiguration->fetch_width == 0) || (INSTRUCTION_QUEUE_LENGTH < a_pConfiguration->fetch_width) ||
+	    (a_pConfiguration->issue_width == 0) || (INSTRUCTION_QUEUE_LENGTH < a_pConfiguration->issue_width)) { /* Wider than the queue never helps */
+		Message_Print("[Error] fetch_width and issue_width must be between 1 and %d\n", INSTRUCTION_QUEUE_LENGTH);
 		return FAILURE;
 	}
-	/* Allocating mem for the instruction FU strings (for trace purposes) */
-	a_pThis->instructionFUs = calloc(a_NumberOfInstructions, sizeof(char*));
-	for (i=0; i<(size_t)a_NumberOfInstructions; ++i) {
-		a_pThis->instructionFUs[i] = calloc(MAX_LENGTH_OF_FU_NAME, sizeof(char));
+	if (scoreboard_initializeFUs(a_pThis) == FAILURE) {
+		return FAILURE;
+	}
+	if (scoreboard_findTracedUnits(a_pThis) == FAILURE) {
+		return FAILURE;
+	}
+	for (i=0; i<(size_t)a_NumberOfInstructions; ++i) { /* Without a FU of its type the instruction would stall the issue forever */
+		if ((a_pProgram[i].opcode < NUM_OF_FU_TYPES) && (a_pThis->FUsNum[a_pProgram[i].opcode] == 0)) {
+			Message_Print("[Error] Instruction %u needs a FU type that has no units\n", (unsigned int)i);
+			return FAILURE;
+		}
 	}
-	if (!a_pThis->pLD_FUs || !a_pThis->pST_FUs || !a_pThis->pADD_FUs || !a_pThis->pSUB_FUs || !a_pThis->pMULT_FUs || !a_pThis->pDIV_FUs || !a_pThis->InstructionQ) {
+	/* Allocating mem for the instruction FU ids (for trace purposes) */
+	a_pThis->instructionFUs = malloc((a_NumberOfInstructions + 1) * sizeof(uint16_t));
+	if (!a_pThis->instructionFUs) {
 		return FAILURE;
 	}
+	for (i=0; i<=(size_t)a_NumberOfInstructions; ++i) {
+		a_pThis->instructionFUs[i] = BIN_TRACE_NO_FU;
+	}
 	for (i=0; i<4; ++i) {
-		a_pThis->instructionStatus[i] = calloc(a_NumberOfInstructions, sizeof(uint32_t));
+		a_pThis->instructionStatus[i] = calloc(a_NumberOfInstructions + 1, sizeof(uint32_t));
 		if (!a_pThis->instructionStatus[i]) {
 			return FAILURE;
 		}
 	}
+	scoreboard_resetRegisters(a_pThis->Register);
 	for (i=0; i<NUM_OF_REGISTERS; ++i) {
-		a_pThis->Register[i] = i;
 		a_pThis->registerResultStatus[i] = NULL;
 	}
+	a_pThis->pActiveHead = NULL;
+	a_pThis->pActiveTail = NULL;
+	a_pThis->activeFUs = 0;
+	return SUCCESS;
+}
+
+/* This function rebuilds the FU lists of a restored scoreboard, The free FUs bitmaps follow 'Busy', The active
+ * list follows the 'activeNum' FU ids at 'pActiveIds' (in issue order) and the consumer lists follow 'Qj' and 'Qk' */
+void scoreboard_relinkFUs(stScoreboardCPU* a_pThis, const uint16_t* pActiveIds, unsigned int activeNum) {
+	stFunctionalUnit* currFU = NULL;
+	unsigned int i = 0;
+	a_pThis->pActiveHead = NULL;
+	a_pThis->pActiveTail = NULL;
+	a_pThis->activeFUs = 0;
+	for (i=0; i<a_pThis->numOfFUs; ++i) {
+		currFU = &(a_pThis->pFUs[i]);
+		scoreboard_setFUFree(a_pThis, currFU, !currFU->Busy);
+		currFU->pWaitingJ = NULL;
+		currFU->pWaitingK = NULL;
+	}
+	for (i=0; i<activeNum; ++i) { /* Same order as the issue stage links them */
+		currFU = &(a_pThis->pFUs[pActiveIds[i]]);
+		if (currFU->Qj != NULL) {
+			currFU->pNextWaitingJ = currFU->Qj->pWaitingJ;
+			currFU->Qj->pWaitingJ = currFU;
+		}
+		if (currFU->Qk != NULL) {
+			currFU->pNextWaitingK = currFU->Qk->pWaitingK;
+			currFU->Qk->pWaitingK = currFU;
+		}
+		scoreboard_activateFU(a_pThis, currFU);
+	}
+}
+
+/* This function sets every register to its initial value, Fi = i */
+void scoreboard_resetRegisters(float registers[]) {
+	int i = 0;
+	for (i=0; i<NUM_OF_REGISTERS; ++i) {
+		registers[i] = i;
+	}
+}
+
+/* This function runs the program without any timing, Every command is executed in program order directly on
+ * the registers and the memory, The final registers are stored at 'registers'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool scoreboard_runFunctional(stMemory* pMemory, command_row_t* pProgram, unsigned int instructionNum, float registers[]) {
+	if (instructionNum == pMemory->size) { /* The timing engine fails to fetch past the end of the memory as well */
+		Message_Print("[Error] The program has no HALT command\n");
+		return FAILURE;
+	}
+	scoreboard_resetRegisters(registers);
+	scoreboard_fastForward(pMemory, pProgram, instructionNum, registers);
+	if (pMemory->failed) { /* A store lost its value */
+		Message_Print("[Error] A memory page malloc failed\n");
+		return FAILURE;
+	}
 	return SUCCESS;
 }
 
 /************************************************************************/
 /*	Private functions declaration					*/
 /************************************************************************/
+/* This function appends the FU to the tail of the active FUs list (the list is ordered by issue) */
+void scoreboard_activateFU(stScoreboardCPU* a_pThis, stFunctionalUnit* pFU) {
+	pFU->pNextActive = NULL;
+	pFU->pPrevActive = a_pThis->pActiveTail;
+	if (a_pThis->pActiveTail == NULL) {
+		a_pThis->pActiveHead = pFU;
+	} else {
+		a_pThis->pActiveTail->pNextActive = pFU;
+	}
+	a_pThis->pActiveTail = pFU;
+	a_pThis->activeFUs++;
+}
+
 /* This function checks if the simulation ended and return true if so, otherwise return false */
 bool scoreboard_checkExitConditions(stScoreboardCPU* a_pThis, command_row_t a_cmd) {
-	size_t i = 0;
-	if ((a_cmd.opcode == OPCODE_HALT) || (a_pThis->PC == (MEMORY_SIZE - 1))) { /* If we got the HALT opcode or read all the memory */
-		for (i=0; i<NUM_OF_REGISTERS; ++i) {
-			if (a_pThis->registerResultStatus[i] != NULL) { /* Check for active FUs */
-				return false;
-			}
-		}
-		return true; /* Means that no FU's are active (all are done) */
+	if ((a_cmd.opcode == OPCODE_HALT) || (a_pThis->PC == (a_pThis->pMemory->size - 1))) { /* If we got the HALT opcode or read all the memory */
+		return (a_pThis->activeFUs == 0); /* Means that no FU's are active (all are done) */
 	} else {
 		return false;
 	}
 }
 
+/* This function computes the result of one command from the registers and the memory, A store writes the memory
+ * The result is returned, It is meaningless for a store */
+float scoreboard_computeOper(stMemory* pMemory, const float registers[], opcode_t opcode, reg_t Fj, reg_t Fk, unsigned short int imm) {
+	switch (opcode) {
+		case OPCODE_LD: return scoreboard_convertIntToFloat(Memory_Read(pMemory, imm)); /* Convert int to Single-precision floating-point format */
+		case OPCODE_ST: Memory_Write(pMemory, imm, scoreboard_convertFloatToInt(registers[Fk])); /* Convert Single-precision floating-point format to int */
+				return 0;
+		case OPCODE_ADD: return registers[Fj] + registers[Fk];
+		case OPCODE_SUB: return registers[Fj] - registers[Fk];
+		case OPCODE_MULT: return registers[Fj] * registers[Fk];
+		case OPCODE_DIV: return registers[Fj] / registers[Fk];
+		default:
+			break;
+	}
+	return 0;
+}
+
 /* Convert Single-precision floating-point format to int
  * The integer represent the 32-bit IEEE 754 format of the decimal value */
 uint32_t scoreboard_convertFloatToInt(float input) {
@@ -184,187 +387,319 @@ float scoreboard_convertIntToFloat(uint32_t input) {
 	return (float)*f; /* scoreboard_convertIntToFloat(1034818683) == 0.085; */
 }
 
+/* This function counts the stalls of 'count' quiet cycles, Nothing changes in them so every stall of the
+ * current state repeats in each of them */
+void scoreboard_countQuietStalls(stScoreboardCPU* a_pThis, uint32_t count) {
+	stStats* pStats = a_pThis->pStats;
+	stFunctionalUnit* currFU = NULL;
+	command_row_t headCmd;
+	if (InstQ_Peek(&(a_pThis->InstructionQ), &headCmd) == SUCCESS) { /* The issue stage stays stalled, see scoreboard_getQuietCycles() */
+		pStats->issueStalls[scoreboard_getIssueStall(a_pThis, &headCmd)] += count;
+	} else {
+		pStats->issueStalls[ISSUE_STALL_QUEUE_EMPTY_IDX] += count;
+	}
+	for (currFU=a_pThis->pActiveHead; currFU!=NULL; currFU=currFU->pNextActive) {
+		if (a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][currFU->relatedPC] == 0) { /* No FU is ready to read operands in a quiet cycle */
+			pStats->rawStalls += count;
+		}
+	}
+	if (a_pThis->halted != true) { /* The fetch stage stays stalled on the full queue */
+		pStats->fetchStalls += count;
+	}
+	pStats->queueOccupancy[a_pThis->InstructionQ.size] += count;
+}
+
+/* This function unlinks the FU from the active FUs list */
+void scoreboard_deactivateFU(stScoreboardCPU* a_pThis, stFunctionalUnit* pFU) {
+	if (pFU->pPrevActive == NULL) {
+		a_pThis->pActiveHead = pFU->pNextActive;
+	} else {
+		pFU->pPrevActive->pNextActive = pFU->pNextActive;
+	}
+	if (pFU->pNextActive == NULL) {
+		a_pThis->pActiveTail = pFU->pPrevActive;
+	} else {
+		pFU->pNextActive->pPrevActive = pFU->pPrevActive;
+	}
+	pFU->pNextActive = NULL;
+	pFU->pPrevActive = NULL;
+	a_pThis->activeFUs--;
+}
+
 /* This function performs the execution stage of the scorecoard.
  * This function is called until the execution is done */
 void scoreboard_execution(stScoreboardCPU* a_pThis) {
-	size_t i = 0;
-	for (i=0; i<NUM_OF_REGISTERS; ++i) {
-		if (a_pThis->registerResultStatus[i] != NULL) { /* Check for active FUs */
-			int relatedPC = a_pThis->registerResultStatus[i]->relatedPC;
-			if (a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][relatedPC] != a_pThis->cycle) { /* Check that we are not executing in the same cycle as the read operands */
-				if ((a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][relatedPC] != 0) && a_pThis->registerResultStatus[i]->Busy && (a_pThis->registerResultStatus[i]->time_left != 0)) { /* Check the Execution conditions (and read operands stage is already done) */
-					a_pThis->registerResultStatus[i]->time_left--;
-					if (a_pThis->registerResultStatus[i]->time_left == 0) {
-						a_pThis->instructionStatus[EXECUTE_END_STAGE_IDX][relatedPC] = a_pThis->cycle;
-					}
+	stFunctionalUnit* currFU = NULL;
+	for (currFU=a_pThis->pActiveHead; currFU!=NULL; currFU=currFU->pNextActive) {
+		int relatedPC = currFU->relatedPC;
+		if (a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][relatedPC] != a_pThis->cycle) { /* Check that we are not executing in the same cycle as the read operands */
+			if ((a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][relatedPC] != 0) && currFU->Busy && (currFU->time_left != 0)) { /* Check the Execution conditions (and read operands stage is already done) */
+				currFU->time_left--;
+				if (currFU->time_left == 0) {
+					a_pThis->instructionStatus[EXECUTE_END_STAGE_IDX][relatedPC] = a_pThis->cycle;
+					PROBE(a_pThis, PROBE_EXEC_DONE_IDX, a_pThis->cycle, relatedPC, currFU - a_pThis->pFUs);
 				}
 			}
 		}
 	}
 }
 
-/* This function fetches the next instruction from memory into the instruction Queue
+/* This function fetches up to 'fetch_width' instructions from memory into the instruction Queue, It stops after a HALT
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
 bool scoreboard_fetch(stScoreboardCPU* a_pThis) {
 	command_row_t cmd;
-	/* Load & parse PC instruction from memin into the Q */
-	if (parse_opcode(a_pThis->pMemory[a_pThis->PC], &cmd) == FAILURE) {
-		return FAILURE;
-	}
-	if (InstQ_Enqueue(a_pThis->InstructionQ, cmd) == SUCCESS) { /* If enqueue was successful - increase PC */
+	unsigned int fetched = 0;
+	for (fetched=0; (fetched<a_pThis->pConfiguration->fetch_width) && (a_pThis->halted != true); ++fetched) {
+		if (a_pThis->InstructionQ.limit <= a_pThis->InstructionQ.size) { /* A full queue stalls the fetch until the issue pops a command */
+			if ((fetched == 0) && (a_pThis->pStats != NULL)) {
+				a_pThis->pStats->fetchStalls++;
+			}
+			break;
+		}
+		cmd = a_pThis->pProgram[a_pThis->PC]; /* Load the PC instruction, already decoded from memin */
+		if (InstQ_Enqueue(&(a_pThis->InstructionQ), cmd) == FAILURE) {
+			return FAILURE;
+		}
+		PROBE(a_pThis, PROBE_FETCH_IDX, a_pThis->cycle, a_pThis->PC, PROBE_NO_FU); /* Enqueue was successful - increase PC */
 		if (cmd.opcode == OPCODE_HALT) {
 			a_pThis->halted = true;
-		} else if (a_pThis->PC < (MEMORY_SIZE - 1)) {
+		} else if (a_pThis->PC < (a_pThis->pMemory->size - 1)) {
 			a_pThis->PC++;
 		} else {
 			return FAILURE;
 		}
-	} else {
-		return FAILURE;
 	}
 	return SUCCESS;
 }
 
-/* This function looks for an avaliabale Functional Unit based on the opcode
- * and returns the pointer to it, If there isn't avilable FU return NULL */
-stFunctionalUnit* scoreboard_getAvailableFU(stScoreboardCPU* a_pThis, opcode_t a_opcode) {
-	size_t i = 0;
-	switch (a_opcode) {
-		case OPCODE_LD:
-			for (i=0; i<a_pThis->pConfiguration->ld_nr_units; ++i) {
-				if (a_pThis->pLD_FUs[i].Busy == false) {
-					strcpy(a_pThis->instructionFUs[a_pThis->lastIssuedPC], a_pThis->pLD_FUs[i].fuName);
-					a_pThis->pLD_FUs[i].time_left = a_pThis->pConfiguration->ld_delay;
-					return &a_pThis->pLD_FUs[i];
-				}
-			}
-			return NULL; /* Means no FU is available */
-		case OPCODE_ST:
-			for (i=0; i<a_pThis->pConfiguration->st_nr_units; ++i) {
-				if (a_pThis->pST_FUs[i].Busy == false) {
-					strcpy(a_pThis->instructionFUs[a_pThis->lastIssuedPC], a_pThis->pST_FUs[i].fuName);
-					a_pThis->pST_FUs[i].time_left = a_pThis->pConfiguration->st_delay;
-					return &a_pThis->pST_FUs[i];
-				}
-			}
-			return NULL; /* Means no FU is available */
-		case OPCODE_ADD:
-			for (i=0; i<a_pThis->pConfiguration->add_nr_units; ++i) {
-				if (a_pThis->pADD_FUs[i].Busy == false) {
-					strcpy(a_pThis->instructionFUs[a_pThis->lastIssuedPC], a_pThis->pADD_FUs[i].fuName);
-					a_pThis->pADD_FUs[i].time_left = a_pThis->pConfiguration->add_delay;
-					return &a_pThis->pADD_FUs[i];
-				}
+/* This function returns the index of the lowest set bit, The word must not be zero */
+int scoreboard_findFirstSet(uint64_t word) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(word);
+#else
+	int idx = 0;
+	while ((word & 0x1) == 0) {
+		word = word >> 1;
+		idx++;
+	}
+	return idx;
+#endif /* __GNUC__ */
+}
+
+/* This function finds the traced units listed in the configuration, 'ALL' traces every FU and an empty list none
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool scoreboard_findTracedUnits(stScoreboardCPU* a_pThis) {
+	char names[CONFIGURATION_STR_MAX_LENGTH+1] = {0};
+	char* name = NULL;
+	char* nextName = NULL;
+	bool* isTraced = NULL;
+	unsigned int i = 0;
+	size_t length = 0;
+	bool isValid = true, found = false;
+	isTraced = calloc(a_pThis->numOfFUs + 1, sizeof(bool));
+	a_pThis->pTracedUnits = malloc((a_pThis->numOfFUs + 1) * sizeof(stFunctionalUnit*));
+	a_pThis->pTraceRows = malloc((a_pThis->numOfFUs + 1) * sizeof(stTraceRow));
+	if (!isTraced || !a_pThis->pTracedUnits || !a_pThis->pTraceRows) {
+		free(isTraced);
+		return FAILURE;
+	}
+	memcpy(names, a_pThis->pConfiguration->trace_unit, CONFIGURATION_STR_MAX_LENGTH); /* The last byte of 'names' stays zero */
+	if (strcmp(names, TRACE_ALL_UNITS) == 0) {
+		for (i=0; i<a_pThis->numOfFUs; ++i) {
+			isTraced[i] = true;
+		}
+	} else {
+		for (name=names; isValid && (name != NULL); name=nextName) { /* Not strtok(), jobs initialize in parallel */
+			nextName = strchr(name, ',');
+			if (nextName != NULL) {
+				*nextName++ = '\0';
 			}
-			return NULL; /* Means no FU is available */
-		case OPCODE_SUB:
-			for (i=0; i<a_pThis->pConfiguration->sub_nr_units; ++i) {
-				if (a_pThis->pSUB_FUs[i].Busy == false) {
-					strcpy(a_pThis->instructionFUs[a_pThis->lastIssuedPC], a_pThis->pSUB_FUs[i].fuName);
-					a_pThis->pSUB_FUs[i].time_left = a_pThis->pConfiguration->sub_delay;
-					return &a_pThis->pSUB_FUs[i];
-				}
+			if (name[0] == '\0') { /* An empty list means no tracing */
+				continue;
 			}
-			return NULL; /* Means no FU is available */
-		case OPCODE_MULT:
-			for (i=0; i<a_pThis->pConfiguration->mul_nr_units; ++i) {
-				if (a_pThis->pMULT_FUs[i].Busy == false) {
-					strcpy(a_pThis->instructionFUs[a_pThis->lastIssuedPC], a_pThis->pMULT_FUs[i].fuName);
-					a_pThis->pMULT_FUs[i].time_left = a_pThis->pConfiguration->mul_delay;
-					return &a_pThis->pMULT_FUs[i];
+			length = strlen(name);
+			for (i=0, found=false; i<a_pThis->numOfFUs; ++i) { /* A pipelined unit 'ADD0' is traced by all of its slots 'ADD0.<slot>' */
+				if ((strncmp(a_pThis->pFUs[i].fuName, name, length) == 0) && ((a_pThis->pFUs[i].fuName[length] == '\0') || (a_pThis->pFUs[i].fuName[length] == '.'))) {
+					isTraced[i] = true; /* Listing a unit twice traces it once */
+					found = true;
 				}
 			}
-			return NULL; /* Means no FU is available */
-		case OPCODE_DIV:
-			for (i=0; i<a_pThis->pConfiguration->div_nr_units; ++i) {
-				if (a_pThis->pDIV_FUs[i].Busy == false) {
-					strcpy(a_pThis->instructionFUs[a_pThis->lastIssuedPC], a_pThis->pDIV_FUs[i].fuName);
-					a_pThis->pDIV_FUs[i].time_left = a_pThis->pConfiguration->div_delay;
-					return &a_pThis->pDIV_FUs[i];
-				}
+			if (!found) {
+				Message_Print("[Error] Did not found the requested traced unit '%s'\n", name);
+				isValid = false;
 			}
-			return NULL; /* Means no FU is available */
-		default:
-			return NULL;
+		}
 	}
+	for (i=0; i<a_pThis->numOfFUs; ++i) { /* Keep the FU id order, the traced units of every cycle are written in it */
+		if (isTraced[i]) {
+			a_pThis->pTracedUnits[a_pThis->tracedUnitsNum++] = &(a_pThis->pFUs[i]);
+		}
+	}
+	free(isTraced);
+	return isValid;
 }
 
-/* This function Initializes the FUs and finds the traced */
-void scoreboard_initializeFUs(stScoreboardCPU* a_pThis) {
-	size_t i = 0;
-	char fuIdx[2] = { 0 }; //Index is max 2 char 
-	a_pThis->pLD_FUs = calloc(a_pThis->pConfiguration->ld_nr_units, sizeof(stFunctionalUnit));
-	a_pThis->pST_FUs = calloc(a_pThis->pConfiguration->st_nr_units, sizeof(stFunctionalUnit));
-	a_pThis->pADD_FUs = calloc(a_pThis->pConfiguration->add_nr_units, sizeof(stFunctionalUnit));
-	a_pThis->pSUB_FUs = calloc(a_pThis->pConfiguration->sub_nr_units, sizeof(stFunctionalUnit));
-	a_pThis->pMULT_FUs = calloc(a_pThis->pConfiguration->mul_nr_units, sizeof(stFunctionalUnit));
-	a_pThis->pDIV_FUs = calloc(a_pThis->pConfiguration->div_nr_units, sizeof(stFunctionalUnit));
-	for (i=0; i<a_pThis->pConfiguration->ld_nr_units; ++i) {
-			a_pThis->pLD_FUs[i].m_op = OPCODE_LD;
-			strcpy(a_pThis->pLD_FUs[i].fuName, "LD");
-			sprintf(fuIdx, "%ld", i);
-			strcat(a_pThis->pLD_FUs[i].fuName, fuIdx);
-			if (strcmp(a_pThis->pLD_FUs[i].fuName, a_pThis->pConfiguration->trace_unit) == 0) { /* strcmp() return an integer less than, equal to, or greater than zero if s1 is found */
-				a_pThis->pTracedUnit = &a_pThis->pLD_FUs[i];
-			}
+/* This function looks for an avaliabale Functional Unit based on the opcode
+ * and returns the pointer to it, If there isn't avilable FU return NULL */
+stFunctionalUnit* scoreboard_getAvailableFU(stScoreboardCPU* a_pThis, opcode_t a_opcode) {
+	stFunctionalUnit* currFU = NULL;
+	int freeIdx = 0;
+	if ((a_opcode < OPCODE_LD) || (NUM_OF_FU_TYPES <= a_opcode)) { /* HALT has no FU */
+		return NULL;
 	}
-	for (i=0; i<a_pThis->pConfiguration->st_nr_units; ++i) {
-			a_pThis->pST_FUs[i].m_op = OPCODE_ST;
-			strcpy(a_pThis->pST_FUs[i].fuName, "ST");
-			sprintf(fuIdx, "%ld", i);
-			strcat(a_pThis->pST_FUs[i].fuName, fuIdx);
-			if (strcmp(a_pThis->pST_FUs[i].fuName, a_pThis->pConfiguration->trace_unit) == 0) { /* strcmp() return an integer less than, equal to, or greater than zero if s1 is found */
-				a_pThis->pTracedUnit = &a_pThis->pST_FUs[i];
-			}
+	freeIdx = scoreboard_getFirstFreeFU(&(a_pThis->freeFUs[a_opcode]));
+	if (freeIdx < 0) {
+		return NULL; /* Means no FU is available */
 	}
-	for (i=0; i<a_pThis->pConfiguration->add_nr_units; ++i) {
-			a_pThis->pADD_FUs[i].m_op = OPCODE_ADD;
-			strcpy(a_pThis->pADD_FUs[i].fuName, "ADD");
-			sprintf(fuIdx, "%ld", i);
-			strcat(a_pThis->pADD_FUs[i].fuName, fuIdx);
-			if (strcmp(a_pThis->pADD_FUs[i].fuName, a_pThis->pConfiguration->trace_unit) == 0) { /* strcmp() return an integer less than, equal to, or greater than zero if s1 is found */
-				a_pThis->pTracedUnit = &a_pThis->pADD_FUs[i];
-			}
+	currFU = &(a_pThis->pFUs[a_pThis->FUsOffset[a_opcode] + freeIdx]);
+	a_pThis->instructionFUs[a_pThis->lastIssuedPC] = (uint16_t)(currFU - a_pThis->pFUs);
+	currFU->time_left = a_pThis->FUsDelay[a_opcode];
+	return currFU;
+}
+
+/* This function returns the index of the lowest free FU in the bitmap, or -1 if all of them are busy */
+int scoreboard_getFirstFreeFU(stFreeFUs* pFree) {
+	int wordIdx = 0;
+	if (pFree->summary == 0) {
+		return -1;
 	}
-	for (i=0; i<a_pThis->pConfiguration->sub_nr_units; ++i) {
-			a_pThis->pSUB_FUs[i].m_op = OPCODE_SUB;
-			strcpy(a_pThis->pSUB_FUs[i].fuName, "SUB");
-			sprintf(fuIdx, "%ld", i);
-			strcat(a_pThis->pSUB_FUs[i].fuName, fuIdx);
-			if (strcmp(a_pThis->pSUB_FUs[i].fuName, a_pThis->pConfiguration->trace_unit) == 0) { /* strcmp() return an integer less than, equal to, or greater than zero if s1 is found */
-				a_pThis->pTracedUnit = &a_pThis->pSUB_FUs[i];
-			}
+	wordIdx = scoreboard_findFirstSet(pFree->summary);
+	return (wordIdx * FREE_FUS_WORD_BITS) + scoreboard_findFirstSet(pFree->words[wordIdx]);
+}
+
+/* This function returns the ISSUE_STALL_*_IDX reason the command at the head of the queue can not be issued
+ * It must only be called when the issue of the command is known to fail */
+int scoreboard_getIssueStall(stScoreboardCPU* a_pThis, const command_row_t* pCmd) {
+	if (pCmd->opcode == OPCODE_HALT) {
+		return ISSUE_STALL_HALT_IDX;
 	}
-	for (i=0; i<a_pThis->pConfiguration->mul_nr_units; ++i) {
-			a_pThis->pMULT_FUs[i].m_op = OPCODE_MULT;
-			strcpy(a_pThis->pMULT_FUs[i].fuName, "MUL");
-			sprintf(fuIdx, "%ld", i);
-			strcat(a_pThis->pMULT_FUs[i].fuName, fuIdx);
-			if (strcmp(a_pThis->pMULT_FUs[i].fuName, a_pThis->pConfiguration->trace_unit) == 0) { /* strcmp() return an integer less than, equal to, or greater than zero if s1 is found */
-				a_pThis->pTracedUnit = &a_pThis->pMULT_FUs[i];
-			}
+	if (a_pThis->freeFUs[pCmd->opcode].summary == 0) { /* Same order of checks as scoreboard_issue() */
+		return ISSUE_STALL_STRUCTURAL_IDX;
 	}
-	for (i=0; i<a_pThis->pConfiguration->div_nr_units; ++i) {
-			a_pThis->pDIV_FUs[i].m_op = OPCODE_DIV;
-			strcpy(a_pThis->pDIV_FUs[i].fuName, "DIV");
-			sprintf(fuIdx, "%ld", i);
-			strcat(a_pThis->pDIV_FUs[i].fuName, fuIdx);
-			if (strcmp(a_pThis->pDIV_FUs[i].fuName, a_pThis->pConfiguration->trace_unit) == 0) { /* strcmp() return an integer less than, equal to, or greater than zero if s1 is found */
-				a_pThis->pTracedUnit = &a_pThis->pDIV_FUs[i];
-			}
+	return ISSUE_STALL_WAW_IDX;
+}
+
+/* This function returns the FU id the issue stall of the command waits for, The FU that writes its destination on a
+ * WAW stall and PROBE_NO_FU otherwise, It must only be called when the issue of the command is known to fail */
+int scoreboard_getIssueStallFU(stScoreboardCPU* a_pThis, const command_row_t* pCmd) {
+	if (scoreboard_getIssueStall(a_pThis, pCmd) != ISSUE_STALL_WAW_IDX) {
+		return PROBE_NO_FU;
+	}
+	return (int)(a_pThis->registerResultStatus[pCmd->dst] - a_pThis->pFUs);
+}
+
+/* This function returns slot 0 of the pipelined unit of the FU, Which keeps the state of the whole unit */
+stFunctionalUnit* scoreboard_getUnit(stScoreboardCPU* a_pThis, stFunctionalUnit* pFU) {
+	unsigned int offset = a_pThis->FUsOffset[pFU->m_op];
+	unsigned int units = a_pThis->FUsNum[pFU->m_op] / a_pThis->FUsDepth[pFU->m_op];
+	return &(a_pThis->pFUs[offset + ((unsigned int)(pFU - a_pThis->pFUs) - offset) % units]);
+}
+
+/* This function returns how many of the following cycles are quiet, A quiet cycle is a cycle in which
+ * no FU changes its state and only the executing FUs count down their 'time_left' */
+uint32_t scoreboard_getQuietCycles(stScoreboardCPU* a_pThis) {
+	command_row_t headCmd;
+	stFunctionalUnit* currFU = NULL;
+	uint32_t minTimeLeft = 0;
+	if ((a_pThis->halted != true) && (a_pThis->InstructionQ.size < a_pThis->InstructionQ.limit)) { /* The fetch stage changes the state unless it is done or stalled */
+		return 0;
+	}
+	if (InstQ_Peek(&(a_pThis->InstructionQ), &headCmd) == SUCCESS) { /* The issue stage must stay stalled, Same conditions as scoreboard_issue() */
+		if ((headCmd.opcode != OPCODE_HALT) && (a_pThis->freeFUs[headCmd.opcode].summary != 0) &&
+		    ((a_pThis->engine == ENGINE_TOMASULO) || (a_pThis->registerResultStatus[headCmd.dst] == NULL) || (headCmd.dstMask == 0))) { /* Tomasulo renames instead of a WAW stall */
+			return 0;
+		}
+	}
+	for (currFU=a_pThis->pActiveHead; currFU!=NULL; currFU=currFU->pNextActive) {
+		if ((currFU->Rj && currFU->Rk) || (currFU->time_left == 0)) { /* Ready to read operands or to write results */
+			return 0;
+		}
+		if ((a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][currFU->relatedPC] != 0) && ((minTimeLeft == 0) || (currFU->time_left < minTimeLeft))) {
+			minTimeLeft = currFU->time_left;
+		}
 	}
+	if (minTimeLeft == 0) { /* Nothing is executing, So there is no upcoming event to jump to */
+		return 0;
+	}
+	return minTimeLeft - 1; /* The execution of the first FU ends on the cycle after the last quiet one */
+}
+
+/* This function checks if another active FU still has to read the register the FU writes (a WAR hazard)
+ * A FU reads its sources when it reads its operands, Until then 'Rj'/'Rk' tell that the source is ready, Return true if so */
+bool scoreboard_hasPendingReader(stScoreboardCPU* a_pThis, const stFunctionalUnit* pWriter) {
+	stFunctionalUnit* currFU = NULL;
+	for (currFU=a_pThis->pActiveHead; currFU!=NULL; currFU=currFU->pNextActive) {
+		if ((currFU == pWriter) || (currFU->m_op == OPCODE_LD)) { /* A load reads no register */
+			continue;
+		}
+		if ((currFU->m_op != OPCODE_ST) && (currFU->Fj == pWriter->Fi) && currFU->Rj) { /* A store reads only the register it stores */
+			return true;
+		}
+		if ((currFU->Fk == pWriter->Fi) && currFU->Rk) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* This function Initializes the FUs and finds the traced */
+bool scoreboard_initializeFUs(stScoreboardCPU* a_pThis) {
+	configuration* pConfig = a_pThis->pConfiguration;
+	unsigned short int nrUnits[NUM_OF_FU_TYPES] = { pConfig->ld_nr_units, pConfig->st_nr_units, pConfig->add_nr_units, pConfig->sub_nr_units, pConfig->mul_nr_units, pConfig->div_nr_units };
+	unsigned short int delays[NUM_OF_FU_TYPES] = { pConfig->ld_delay, pConfig->st_delay, pConfig->add_delay, pConfig->sub_delay, pConfig->mul_delay, pConfig->div_delay };
+	unsigned short int depths[NUM_OF_FU_TYPES] = { pConfig->ld_pipeline_depth, pConfig->st_pipeline_depth, pConfig->add_pipeline_depth, pConfig->sub_pipeline_depth, pConfig->mul_pipeline_depth, pConfig->div_pipeline_depth };
+	unsigned short int intervals[NUM_OF_FU_TYPES] = { pConfig->ld_init_interval, pConfig->st_init_interval, pConfig->add_init_interval, pConfig->sub_init_interval, pConfig->mul_init_interval, pConfig->div_init_interval };
+	stFunctionalUnit* currFU = NULL;
+	size_t i = 0, op = 0;
+	a_pThis->numOfFUs = 0;
+	for (op=0; op<NUM_OF_FU_TYPES; ++op) {
+		if ((depths[op] == 0) || (MAX_PIPELINE_DEPTH < depths[op]) || (intervals[op] == 0) || (CONFIGURATION_INT_MAX_VALUE < nrUnits[op] * depths[op])) {
+			Message_Print("[Error] The pipeline depth must be between 1 and %d, The initiation interval at least 1 and the units times the depth up to %d\n",
+				MAX_PIPELINE_DEPTH, CONFIGURATION_INT_MAX_VALUE);
+			return FAILURE;
+		}
+		a_pThis->FUsOffset[op] = a_pThis->numOfFUs;
+		a_pThis->FUsNum[op] = nrUnits[op] * depths[op]; /* Every slot of a unit is a FU of its own */
+		a_pThis->FUsDepth[op] = depths[op];
+		a_pThis->FUsDelay[op] = delays[op];
+		a_pThis->FUsInterval[op] = intervals[op];
+		a_pThis->numOfFUs += a_pThis->FUsNum[op];
+	}
+	a_pThis->pFUs = calloc(a_pThis->numOfFUs, sizeof(stFunctionalUnit));
+	if (!a_pThis->pFUs && (a_pThis->numOfFUs != 0)) {
+		return FAILURE;
+	}
+	memset(a_pThis->freeFUs, 0, sizeof(a_pThis->freeFUs));
+	for (op=0; op<NUM_OF_FU_TYPES; ++op) {
+		for (i=0; i<a_pThis->FUsNum[op]; ++i) { /* Slot 0 of all the units first, So the issue spreads the commands over the units */
+			currFU = &(a_pThis->pFUs[a_pThis->FUsOffset[op] + i]);
+			currFU->m_op = (opcode_t)op;
+			Trace_FormatFUName(currFU->fuName, (int)op, (unsigned int)i, a_pThis->FUsNum[op], a_pThis->FUsDepth[op]);
+			scoreboard_setFUFree(a_pThis, currFU, true);
+		}
+	}
+	return SUCCESS;
+}
+
+/* This function checks that the initiation interval of the unit of the FU passed since the unit last started
+ * executing a command, So the FU can start now, Return true if so, otherwise return false */
+bool scoreboard_isUnitReady(stScoreboardCPU* a_pThis, stFunctionalUnit* pFU) {
+	uint32_t lastStartCycle = scoreboard_getUnit(a_pThis, pFU)->lastStartCycle;
+	return (lastStartCycle == 0) || (a_pThis->FUsInterval[pFU->m_op] <= a_pThis->cycle - lastStartCycle); /* Cycles start from 1 */
 }
 
 /* This function performs the issue stage of the scorecoard, Before issuing the command it checks if
  * there is no structural hazard (FU is available) and that there is no output dependency (WAW)
+ * The Tomasulo engine renames the destination instead, So only the structural hazard stalls it
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
 bool scoreboard_issue(stScoreboardCPU* a_pThis, command_row_t a_cmd) {
 	stFunctionalUnit* currFunctionalUnit = scoreboard_getAvailableFU(a_pThis, (opcode_t)a_cmd.opcode);
 	if (a_cmd.opcode == OPCODE_HALT) {
 		return FAILURE;
 	}
-	if (((a_pThis->registerResultStatus[a_cmd.dst] == NULL) || a_cmd.opcode == OPCODE_ST) && (currFunctionalUnit != NULL)) { /* Check the Issue conditions */
+	if (((a_pThis->engine == ENGINE_TOMASULO) || (a_pThis->registerResultStatus[a_cmd.dst] == NULL) || (a_cmd.dstMask == 0)) && (currFunctionalUnit != NULL)) { /* Check the Issue conditions, Stores have no destination */
 		currFunctionalUnit->Busy = true;
+		scoreboard_setFUFree(a_pThis, currFunctionalUnit, false);
 		currFunctionalUnit->Fi = a_cmd.dst;
 		currFunctionalUnit->Fj = a_cmd.src0;
 		currFunctionalUnit->Fk = a_cmd.src1;
@@ -387,9 +722,23 @@ bool scoreboard_issue(stScoreboardCPU* a_pThis, command_row_t a_cmd) {
 			currFunctionalUnit->Rj = (currFunctionalUnit->Qj == NULL);
 			currFunctionalUnit->Rk = (currFunctionalUnit->Qk == NULL);
 		}
-		a_pThis->registerResultStatus[a_cmd.dst] = currFunctionalUnit;
+		currFunctionalUnit->Vj = a_pThis->Register[currFunctionalUnit->Fj]; /* The operands that are ready, The others come with the result of their producer */
+		currFunctionalUnit->Vk = a_pThis->Register[currFunctionalUnit->Fk];
+		if (currFunctionalUnit->Qj != NULL) { /* Register as a consumer, the producer wakes us up when it writes its result */
+			currFunctionalUnit->pNextWaitingJ = currFunctionalUnit->Qj->pWaitingJ;
+			currFunctionalUnit->Qj->pWaitingJ = currFunctionalUnit;
+		}
+		if (currFunctionalUnit->Qk != NULL) {
+			currFunctionalUnit->pNextWaitingK = currFunctionalUnit->Qk->pWaitingK;
+			currFunctionalUnit->Qk->pWaitingK = currFunctionalUnit;
+		}
+		if (a_cmd.dstMask != 0) { /* A store has no destination, Marking its 'dst' field would hide the real producer of that register */
+			a_pThis->registerResultStatus[a_cmd.dst] = currFunctionalUnit;
+		}
+		scoreboard_activateFU(a_pThis, currFunctionalUnit);
 		currFunctionalUnit->relatedPC = (a_pThis->lastIssuedPC++); /* We return current issued PC and increase it by one */
 		a_pThis->instructionStatus[ISSUE_STAGE_IDX][currFunctionalUnit->relatedPC] = a_pThis->cycle; /* Save the issue stage cycle */
+		PROBE(a_pThis, PROBE_ISSUE_IDX, a_pThis->cycle, currFunctionalUnit->relatedPC, currFunctionalUnit - a_pThis->pFUs);
 
 		return SUCCESS;
 	} else {
@@ -397,23 +746,14 @@ bool scoreboard_issue(stScoreboardCPU* a_pThis, command_row_t a_cmd) {
 	}
 }
 
-/* This function performs the operation of the Functional unit */
+/* This function performs the operation of the Functional unit, The Tomasulo engine uses the operand values it
+ * captured instead of the registers, Which younger commands may already have written */
 void scoreboard_performOper(stScoreboardCPU* a_pThis, stFunctionalUnit* pFU) {
-	switch (pFU->m_op) {
-		case OPCODE_LD: pFU->tempRegister = scoreboard_convertIntToFloat(a_pThis->pMemory[pFU->tempImmidiate]); /* Convert int to Single-precision floating-point format */
-				break;
-		case OPCODE_ST: a_pThis->pMemory[pFU->tempImmidiate] = scoreboard_convertFloatToInt(a_pThis->Register[pFU->Fk]); /* Convert Single-precision floating-point format to int */
-				break;
-		case OPCODE_ADD:pFU->tempRegister = a_pThis->Register[pFU->Fj] + a_pThis->Register[pFU->Fk];
-				break;
-		case OPCODE_SUB:pFU->tempRegister = a_pThis->Register[pFU->Fj] - a_pThis->Register[pFU->Fk];
-				break;
-		case OPCODE_MULT:pFU->tempRegister = a_pThis->Register[pFU->Fj] * a_pThis->Register[pFU->Fk];
-				break;
-		case OPCODE_DIV:pFU->tempRegister = a_pThis->Register[pFU->Fj] / a_pThis->Register[pFU->Fk];
-				break;
-		default:
-			break;
+	float operands[2] = { pFU->Vj, pFU->Vk };
+	if (a_pThis->engine == ENGINE_TOMASULO) {
+		pFU->tempRegister = scoreboard_computeOper(a_pThis->pMemory, operands, pFU->m_op, REGISTER_F0, REGISTER_F1, pFU->tempImmidiate);
+	} else {
+		pFU->tempRegister = scoreboard_computeOper(a_pThis->pMemory, a_pThis->Register, pFU->m_op, pFU->Fj, pFU->Fk, pFU->tempImmidiate);
 	}
 }
 
@@ -437,98 +777,169 @@ void scoreboard_printCommand(command_row_t* command) {
 	}
 }
 
+/* This function fires the issue stall probe for every one of 'count' quiet cycles, The stall of the current
+ * state repeats in each of them */
+void scoreboard_probeQuietCycles(stScoreboardCPU* a_pThis, uint32_t count) {
+#if PROBE_MODE != PROBE_MODE_NONE
+	command_row_t headCmd;
+	int fuId = PROBE_NO_FU;
+	uint32_t i = 0;
+	if (InstQ_Peek(&(a_pThis->InstructionQ), &headCmd) == SUCCESS) { /* The issue stage stays stalled, see scoreboard_getQuietCycles() */
+		fuId = scoreboard_getIssueStallFU(a_pThis, &headCmd);
+	}
+	for (i=1; i<=count; ++i) {
+		PROBE(a_pThis, PROBE_ISSUE_STALL_IDX, a_pThis->cycle + i, a_pThis->lastIssuedPC, fuId);
+	}
+#else
+	(void)a_pThis;
+	(void)count;
+#endif /* PROBE_MODE */
+}
+
 /* This function performs the Read operands stage of the scorecoard. It checks if there is no
  * data hazards (RAW) before starting the execution (first cycle of execution is done here) */
 void scoreboard_readOperands(stScoreboardCPU* a_pThis) {
+	stFunctionalUnit* currFU = NULL;
 	int relatedPC = 0;
-	size_t i = 0;
-	for (i=0; i<NUM_OF_REGISTERS; ++i) {
-		if (a_pThis->registerResultStatus[i] != NULL) { /* Check for active FUs */
-			stFunctionalUnit *currFU = a_pThis->registerResultStatus[i];
-			relatedPC = currFU->relatedPC;
-			if (a_pThis->instructionStatus[ISSUE_STAGE_IDX][relatedPC] != a_pThis->cycle) { /* Check that we are not reading the operands in the same cycle as the issue cycle */
-				if (currFU->Busy && currFU->Rj && currFU->Rk) { /* Check the ReadOperands conditions */
-					currFU->Rj = false;
-					currFU->Rk = false;
-					currFU->time_left--;
-					scoreboard_performOper(a_pThis, currFU);
-					a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][relatedPC] = a_pThis->cycle;
-				}
+	for (currFU=a_pThis->pActiveHead; currFU!=NULL; currFU=currFU->pNextActive) {
+		relatedPC = currFU->relatedPC;
+		if (a_pThis->instructionStatus[ISSUE_STAGE_IDX][relatedPC] != a_pThis->cycle) { /* Check that we are not reading the operands in the same cycle as the issue cycle */
+			if (currFU->Busy && currFU->Rj && currFU->Rk && scoreboard_isUnitReady(a_pThis, currFU)) { /* Check the ReadOperands conditions */
+				scoreboard_getUnit(a_pThis, currFU)->lastStartCycle = a_pThis->cycle;
+				currFU->Rj = false;
+				currFU->Rk = false;
+				currFU->time_left--;
+				scoreboard_performOper(a_pThis, currFU);
+				a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][relatedPC] = a_pThis->cycle;
+				PROBE(a_pThis, PROBE_READ_OPERANDS_IDX, a_pThis->cycle, relatedPC, currFU - a_pThis->pFUs);
+			} else if ((a_pThis->pStats != NULL) && currFU->Busy && !(currFU->Rj && currFU->Rk) && (a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][relatedPC] == 0)) {
+				a_pThis->pStats->rawStalls++; /* Waiting for an operand, Not for the initiation interval of its unit */
 			}
 		}
 	}
 }
 
+/* This function marks the FU as free or busy in the free FUs bitmap of its type */
+void scoreboard_setFUFree(stScoreboardCPU* a_pThis, stFunctionalUnit* pFU, bool a_isFree) {
+	stFreeFUs* pFree = &(a_pThis->freeFUs[pFU->m_op]);
+	unsigned int idx = (unsigned int)(pFU - a_pThis->pFUs) - a_pThis->FUsOffset[pFU->m_op];
+	unsigned int wordIdx = idx / FREE_FUS_WORD_BITS;
+	if (a_isFree) {
+		pFree->words[wordIdx] |= ((uint64_t)1 << (idx % FREE_FUS_WORD_BITS));
+		pFree->summary |= ((uint64_t)1 << wordIdx);
+	} else {
+		pFree->words[wordIdx] &= ~((uint64_t)1 << (idx % FREE_FUS_WORD_BITS));
+		if (pFree->words[wordIdx] == 0) {
+			pFree->summary &= ~((uint64_t)1 << wordIdx);
+		}
+	}
+}
+
+/* This function skips over quiet cycles, Counting down the executing FUs and tracing every skipped cycle */
+void scoreboard_skipCycles(stScoreboardCPU* a_pThis, uint32_t a_quietCycles, stTraceFile* pTrace) {
+	uint32_t lastQuietCycle = a_pThis->cycle + a_quietCycles;
+	stFunctionalUnit* currFU = NULL;
+	if (a_quietCycles == 0) {
+		return;
+	}
+	for (currFU=a_pThis->pActiveHead; currFU!=NULL; currFU=currFU->pNextActive) {
+		if (currFU->Busy && (a_pThis->instructionStatus[READ_REGISTERS_STAGE_IDX][currFU->relatedPC] != 0)) { /* Check for executing FUs */
+			currFU->time_left -= a_quietCycles;
+		}
+	}
+	if (a_pThis->pStats != NULL) {
+		scoreboard_countQuietStalls(a_pThis, a_quietCycles);
+	}
+	if ((PROBE_MODE != PROBE_MODE_NONE) && (a_pThis->pProbes != NULL)) {
+		scoreboard_probeQuietCycles(a_pThis, a_quietCycles);
+	}
+	a_pThis->cycle++;
+	scoreboard_writeTracedUnit(a_pThis, pTrace, a_quietCycles); /* The traced unit does not change in quiet cycles */
+	a_pThis->cycle = lastQuietCycle;
+}
+
 /* This function performs the Write results stage of the scorecoard.
- * It stalls until there is no WAR hazrad with previous instructions */
+ * It stalls until there is no WAR hazrad with previous instructions, The Tomasulo engine has no WAR hazards
+ * but broadcasts one result every cycle on the common data bus, The oldest first */
 void scoreboard_writeResults(stScoreboardCPU* a_pThis) {
-	bool isReadyToWriteResult = true;
+	stFunctionalUnit* currFU = NULL;
+	stFunctionalUnit* nextFU = NULL;
+	stFunctionalUnit* waitingFU = NULL;
 	int relatedPC = 0;
-	size_t i = 0, j = 0;
-	for (i=0; i<NUM_OF_REGISTERS; ++i) {
-		if (a_pThis->registerResultStatus[i] != NULL) { /* Check for active FUs */
-			stFunctionalUnit* currFU = a_pThis->registerResultStatus[i];
-			relatedPC = currFU->relatedPC;
-			if (a_pThis->instructionStatus[EXECUTE_END_STAGE_IDX][relatedPC] != a_pThis->cycle) { /* Check that we are not writing back in the same cycle as the executuin */
-				if (currFU->Busy && (currFU->time_left == 0)) { /* Check that execution finished */
-					isReadyToWriteResult = true;
-					for (j=0; j<NUM_OF_REGISTERS; ++j) {
-						if ((i != j) && (((currFU->Fi == currFU->Fj) && currFU->Rj) ||((currFU->Fi == currFU->Fk) && currFU->Rk))) { /* Check the WriteResults conditions */
-							isReadyToWriteResult = false;
-							break;
+	bool isBusFree = true;
+	for (currFU=a_pThis->pActiveHead; currFU!=NULL; currFU=nextFU) {
+		nextFU = currFU->pNextActive; /* currFU might leave the active list during this iteration */
+		relatedPC = currFU->relatedPC;
+		if (a_pThis->instructionStatus[EXECUTE_END_STAGE_IDX][relatedPC] != a_pThis->cycle) { /* Check that we are not writing back in the same cycle as the executuin */
+			if (currFU->Busy && (currFU->time_left == 0)) { /* Check that execution finished */
+				if (a_pThis->engine == ENGINE_TOMASULO) {
+					if (!isBusFree && (currFU->m_op != OPCODE_ST)) { /* A store has no result to broadcast */
+						if (a_pThis->pStats != NULL) {
+							a_pThis->pStats->cdbStalls++;
 						}
+						continue;
 					}
-					if (isReadyToWriteResult) { /* Perform the WriteResults and update all the other FUs who wait for the data to be written */
-						for (j=0; j<NUM_OF_REGISTERS; ++j) {
-							if (a_pThis->registerResultStatus[j] != NULL) {
-								if (currFU == a_pThis->registerResultStatus[j]->Qj) {
-									a_pThis->registerResultStatus[j]->Rj = true;
-									a_pThis->registerResultStatus[j]->Qj = NULL;
-								}
-								if (currFU == a_pThis->registerResultStatus[j]->Qk) {
-									a_pThis->registerResultStatus[j]->Rk = true;
-									a_pThis->registerResultStatus[j]->Qk = NULL;
-								}
-							}
-						}
-						if (currFU->m_op != OPCODE_ST) { /* If it is store command we are not writing back to register */
-							a_pThis->Register[currFU->Fi] = currFU->tempRegister;
-						}
-						currFU->Busy = false;
-						a_pThis->registerResultStatus[i] = NULL;
-						a_pThis->instructionStatus[WRITE_RESULT_STAGE_IDX][relatedPC] = a_pThis->cycle;
+					isBusFree = isBusFree && (currFU->m_op == OPCODE_ST);
+				} else if ((currFU->m_op != OPCODE_ST) && scoreboard_hasPendingReader(a_pThis, currFU)) { /* Check the WriteResults conditions, A store writes no register */
+					PROBE(a_pThis, PROBE_WAR_STALL_IDX, a_pThis->cycle, relatedPC, currFU - a_pThis->pFUs);
+					if (a_pThis->pStats != NULL) {
+						a_pThis->pStats->warStalls++;
 					}
+					continue;
+				}
+				/* Perform the WriteResults and wake up exactly the FUs who wait for the data to be written */
+				for (waitingFU=currFU->pWaitingJ; waitingFU!=NULL; waitingFU=waitingFU->pNextWaitingJ) {
+					waitingFU->Rj = true;
+					waitingFU->Qj = NULL;
+					waitingFU->Vj = currFU->tempRegister;
+				}
+				for (waitingFU=currFU->pWaitingK; waitingFU!=NULL; waitingFU=waitingFU->pNextWaitingK) {
+					waitingFU->Rk = true;
+					waitingFU->Qk = NULL;
+					waitingFU->Vk = currFU->tempRegister;
+				}
+				currFU->pWaitingJ = NULL;
+				currFU->pWaitingK = NULL;
+				if ((currFU->m_op != OPCODE_ST) && ((a_pThis->engine == ENGINE_SCOREBOARD) || (a_pThis->registerResultStatus[currFU->Fi] == currFU))) {
+					a_pThis->Register[currFU->Fi] = currFU->tempRegister; /* A store has no result, With renaming only the last producer of the register writes it */
 				}
+				if (a_pThis->registerResultStatus[currFU->Fi] == currFU) {
+					a_pThis->registerResultStatus[currFU->Fi] = NULL;
+				}
+				currFU->Busy = false;
+				currFU->busyCycles += a_pThis->cycle - a_pThis->instructionStatus[ISSUE_STAGE_IDX][relatedPC];
+				scoreboard_setFUFree(a_pThis, currFU, true);
+				scoreboard_deactivateFU(a_pThis, currFU);
+				a_pThis->instructionStatus[WRITE_RESULT_STAGE_IDX][relatedPC] = a_pThis->cycle;
+				PROBE(a_pThis, PROBE_WRITEBACK_IDX, a_pThis->cycle, relatedPC, currFU - a_pThis->pFUs);
 			}
 		}
 	}
 }
 
 /* this function writes to the traceunit file in the right format */
-void scoreboard_writeTracedUnit( stScoreboardCPU* a_pThis, FILE* fp) {
-	if (a_pThis->pTracedUnit->Busy == true) {
-		char nameFi[4] = {0};
-		char nameFj[4] = {0};
-		char nameFk[4] = {0};
-		char nameQj[MAX_LENGTH_OF_FU_NAME] = {0};
-		char nameQk[MAX_LENGTH_OF_FU_NAME] = {0};
-		char nameRj[4] = {0};
-		char nameRk[4] = {0};
-		sprintf(nameFi, "F%d", (uint8_t)a_pThis->pTracedUnit->Fi);
-		sprintf(nameFj, "F%d", (uint8_t)a_pThis->pTracedUnit->Fj);
-		sprintf(nameFk, "F%d", (uint8_t)a_pThis->pTracedUnit->Fk);
-		if (a_pThis->pTracedUnit->Qj == NULL) {
-			strcpy(nameQj, "-");
-		} else {
-			sprintf(nameQj, "%s", a_pThis->pTracedUnit->Qj->fuName);
-		}
-		if (a_pThis->pTracedUnit->Qk == NULL) {
-			strcpy(nameQk, "-");
-		} else {
-			sprintf(nameQk, "%s", a_pThis->pTracedUnit->Qk->fuName);
+void scoreboard_writeTracedUnit(stScoreboardCPU* a_pThis, stTraceFile* pTrace, uint32_t count) {
+	stFunctionalUnit* pFU = NULL;
+	stTraceRow* pRow = NULL;
+	unsigned int i = 0, rowsNum = 0;
+	if (pTrace == NULL) { /* Tracing is off */
+		return;
+	}
+	for (i=0; i<a_pThis->tracedUnitsNum; ++i) { /* Only busy units are traced */
+		pFU = a_pThis->pTracedUnits[i];
+		if (pFU->Busy == false) {
+			continue;
 		}
-		(a_pThis->pTracedUnit->Rj)? strcpy(nameRj, "Yes"): strcpy(nameRj, "No");
-		(a_pThis->pTracedUnit->Rk) ? strcpy(nameRk, "Yes") : strcpy(nameRk, "No");
-		fprintf(fp, "%d %s %s %s %s %s %s %s %s\n", a_pThis->cycle, a_pThis->pTracedUnit->fuName, nameFi, nameFj, nameFk, nameQj, nameQk, nameRj, nameRk);
+		pRow = &(a_pThis->pTraceRows[rowsNum++]);
+		pRow->unitId = (uint16_t)(pFU - a_pThis->pFUs);
+		pRow->Fi = (uint8_t)pFU->Fi;
+		pRow->Fj = (uint8_t)pFU->Fj;
+		pRow->Fk = (uint8_t)pFU->Fk;
+		pRow->flags = (pFU->Rj ? BIN_TRACE_FLAG_RJ : 0) | (pFU->Rk ? BIN_TRACE_FLAG_RK : 0) | (pFU->Qj ? BIN_TRACE_FLAG_QJ : 0) | (pFU->Qk ? BIN_TRACE_FLAG_QK : 0);
+		pRow->Qj = pFU->Qj ? (uint16_t)(pFU->Qj - a_pThis->pFUs) : BIN_TRACE_NO_FU;
+		pRow->Qk = pFU->Qk ? (uint16_t)(pFU->Qk - a_pThis->pFUs) : BIN_TRACE_NO_FU;
+	}
+	if (rowsNum != 0) {
+		Trace_AddUnitRows(pTrace, a_pThis->cycle, count, a_pThis->pTraceRows, rowsNum);
 	}
 }
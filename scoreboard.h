@@ -2,16 +2,34 @@
 #define SCOREBOARD_H_
 
 #include "defines.h"
+#include "checkpoint.h"
 #include "inst_queue.h"
+#include "memory.h"
+#include "message.h"
+#include "probe.h"
+#include "trace.h"
 #include "input_output.h"
 
-/* This function runs the pipeline
+/* This function runs the pipeline from the current cycle, The traced units are written to the open trace 'pTrace'
+ * unless it is NULL, A checkpoint is saved when the cycle 'checkpointCycle' starts if 'pCheckpointPath' is set
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool scoreboard_cycle(stScoreboardCPU *, char *);
-/* Destroy the scoreboard */
-void scoreboard_destroy(stScoreboardCPU *, configuration *, int);
-/* This function initializes the scoreboard module
+bool scoreboard_cycle(stScoreboardCPU *, stTraceFile *);
+/* Destroy the scoreboard, The program is owned by the caller since it can be shared by many scoreboards */
+void scoreboard_destroy(stScoreboardCPU *, configuration *);
+/* This function executes the 'count' commands at 'pCommands' without any timing, in program order, directly on
+ * 'registers' and the memory, It is the architectural fast forward of the timing free engines */
+void scoreboard_fastForward(stMemory *, const command_row_t *, unsigned int, float []);
+/* This function initializes the scoreboard module, The scoreboard must be destroyed even if the initialization failed
  * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
-bool scoreboard_init(stScoreboardCPU *, configuration *, uint32_t *, int);
+bool scoreboard_init(stScoreboardCPU *, configuration *, stMemory *, command_row_t *, int);
+/* This function rebuilds the FU lists of a restored scoreboard, The free FUs bitmaps follow 'Busy', The active
+ * list follows the 'activeNum' FU ids at 'pActiveIds' (in issue order) and the consumer lists follow 'Qj' and 'Qk' */
+void scoreboard_relinkFUs(stScoreboardCPU *, const uint16_t *, unsigned int);
+/* This function sets every register to its initial value, Fi = i */
+void scoreboard_resetRegisters(float []);
+/* This function runs the program without any timing, Every command is executed in program order directly on
+ * the registers and the memory, The final registers are stored at 'registers'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool scoreboard_runFunctional(stMemory *, command_row_t *, unsigned int, float []);
 
 #endif /* SCOREBOARD_H_ */
@@ -1,65 +1,102 @@
 #include "sim.h"
 
 int main(int argc, char** argv) {
-	/* Check input arguments */
-	if (argc != 7) {
-		print_usage();
-		return EXIT_FAILURE;
-	}
-	if ((check_files_permission("cfg",	argv[1], CHECK_INPUT_FILE) == FAILURE) |
-	    (check_files_permission("memin",	argv[2], CHECK_INPUT_FILE) == FAILURE) |
-	    (check_files_permission("memout",	argv[3], CHECK_OUTPUT_FILE) == FAILURE) |
-	    (check_files_permission("regout",	argv[4], CHECK_OUTPUT_FILE) == FAILURE) |
-	    (check_files_permission("traceinst",argv[5], CHECK_OUTPUT_FILE) == FAILURE) |
-	    (check_files_permission("traceunit",argv[6], CHECK_OUTPUT_FILE) == FAILURE)) {
-		return EXIT_FAILURE;
-	}
-	configuration* config = (configuration*) malloc(sizeof(configuration));
-	if (!config) {
-		printf("[Fatal] Configuration malloc failed\n");
-		free(config);
-		return EXIT_FAILURE;
-	}
-	if (load_cfg(argv[1], config) == FAILURE) {
-		printf("[Fatal] Parsing configuration file failed\n");
-		free(config);
-		return EXIT_FAILURE;
+	stSimJob job;
+	char* args[NUM_OF_SIM_FILES + 1] = {0};
+	int i = 0, argsNum = 0, threads = 0, firstPath = 0;
+	bool isValid = true, isSingle = true;
+	job.binaryTrace = false;
+	job.sparseMemout = false;
+	job.memorySize = MEMORY_SIZE;
+	job.functional = false;
+	job.selfCheck = false;
+	job.checkpointPath = NULL;
+	job.checkpointCycle = 0;
+	job.restorePath = NULL;
+	job.samplePeriod = 0;
+	job.detailWindow = 0;
+	job.statsPath = NULL;
+	job.probesPath = NULL;
+	job.engine = ENGINE_SCOREBOARD;
+	/* Pick out the options, [--binary-trace] [--sparse-memout] [--memory-size <words>] [--functional] [--self-check]
+	 * [--checkpoint <path>] [--checkpoint-cycle <N>] [--restore <path>] [--sample-period <N> --detail-window <N>]
+	 * [--stats <path>] [--probes <path>] [--tomasulo] [--threads <N>], They can appear anywhere */
+	for (i=1; isValid && (i<argc); ++i) {
+		if (strcmp(argv[i], "--binary-trace") == 0) {
+			job.binaryTrace = true;
+		} else if (strcmp(argv[i], "--sparse-memout") == 0) {
+			job.sparseMemout = true;
+		} else if (strcmp(argv[i], "--functional") == 0) {
+			job.functional = true;
+		} else if (strcmp(argv[i], "--self-check") == 0) {
+			job.selfCheck = true;
+		} else if (strcmp(argv[i], "--tomasulo") == 0) {
+			job.engine = ENGINE_TOMASULO;
+		} else if (strcmp(argv[i], "--memory-size") == 0) {
+			isValid = (i + 1 < argc) && (parse_memory_size(argv[++i], &(job.memorySize)) == SUCCESS);
+		} else if (strcmp(argv[i], "--checkpoint") == 0) {
+			isValid = (i + 1 < argc);
+			job.checkpointPath = isValid ? argv[++i] : NULL;
+		} else if (strcmp(argv[i], "--checkpoint-cycle") == 0) {
+			isValid = (i + 1 < argc) && (sscanf(argv[++i], "%u", &(job.checkpointCycle)) == 1);
+		} else if (strcmp(argv[i], "--restore") == 0) {
+			isValid = (i + 1 < argc);
+			job.restorePath = isValid ? argv[++i] : NULL;
+		} else if (strcmp(argv[i], "--sample-period") == 0) {
+			isValid = (i + 1 < argc) && (sscanf(argv[++i], "%u", &(job.samplePeriod)) == 1) && (0 < job.samplePeriod);
+		} else if (strcmp(argv[i], "--detail-window") == 0) {
+			isValid = (i + 1 < argc) && (sscanf(argv[++i], "%u", &(job.detailWindow)) == 1) && (0 < job.detailWindow);
+		} else if (strcmp(argv[i], "--stats") == 0) {
+			isValid = (i + 1 < argc);
+			job.statsPath = isValid ? argv[++i] : NULL;
+		} else if (strcmp(argv[i], "--probes") == 0) {
+			isValid = (i + 1 < argc);
+			job.probesPath = isValid ? argv[++i] : NULL;
+		} else if (strcmp(argv[i], "--threads") == 0) {
+			isValid = (i + 1 < argc) && (sscanf(argv[++i], "%d", &threads) == 1) && (0 < threads);
+		} else if (argsNum <= NUM_OF_SIM_FILES) {
+			args[argsNum++] = argv[i];
+		} else {
+			isValid = false;
+		}
 	}
-	unsigned int memory[MEMORY_SIZE] = {0};
-	if (load_memin(argv[2], memory) == FAILURE) {
-		printf("[Fatal] Parsing memin file failed\n");
-		free(config);
-		return EXIT_FAILURE;
+	isValid = isValid && !(job.functional && job.selfCheck); /* The self check already runs the timing free engine */
+	isValid = isValid && !(job.functional && (job.engine == ENGINE_TOMASULO)); /* The timing free engine has no timing engine to pick */
+	isValid = isValid && !(job.functional && (job.checkpointPath != NULL)) && ((job.checkpointPath != NULL) || (job.checkpointCycle == 0));
+	isValid = isValid && ((job.restorePath == NULL) || (!job.binaryTrace && !job.sparseMemout && !job.functional && !job.selfCheck &&
+							   (job.engine == ENGINE_SCOREBOARD))); /* Taken from the checkpoint */
+	isValid = isValid && ((job.samplePeriod == 0) == (job.detailWindow == 0)) && (job.detailWindow <= job.samplePeriod);
+	isValid = isValid && ((job.samplePeriod == 0) || (!job.binaryTrace && !job.functional && !job.selfCheck &&
+							   (job.checkpointPath == NULL) && (job.restorePath == NULL))); /* No traces are written */
+	isValid = isValid && ((job.statsPath == NULL) || (!job.functional && (job.samplePeriod == 0) && (job.restorePath == NULL))); /* Counted over a whole timing run */
+	isValid = isValid && ((job.probesPath == NULL) || (!job.functional && (job.samplePeriod == 0) && (job.restorePath == NULL))); /* Checked against a whole timing run */
+	isSingle = (job.checkpointPath == NULL) && (job.restorePath == NULL) && (job.statsPath == NULL) && (job.probesPath == NULL); /* These files are for single runs only */
+	/* Batch mode, sim --batch <manifest> [--threads <N>] [--binary-trace] [--sparse-memout] [--memory-size <words>]
+	 * [--functional] [--self-check] [--sample-period <N> --detail-window <N>] [--tomasulo] */
+	if (isValid && isSingle && (argsNum == 2) && (strcmp(args[0], "--batch") == 0)) {
+		return (batch_runManifest(args[1], threads, &job) == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
-
-	unsigned int instructionNum = get_instructionNum(memory);
-	/* Start the program */
-	stScoreboardCPU scoreboardCPU;
-	if (scoreboard_init(&scoreboardCPU, config, memory, instructionNum) == FAILURE) {
-		return EXIT_FAILURE;
+	/* Sweep mode, sim --sweep <sweep> <memin> <csv> [--threads <N>] [--memory-size <words>] [--tomasulo] */
+	if (isValid && isSingle && (argsNum == 4) && (strcmp(args[0], "--sweep") == 0) && !job.binaryTrace && !job.sparseMemout &&
+	    !job.functional && !job.selfCheck && (job.samplePeriod == 0)) {
+		return (sweep_run(args[1], args[2], args[3], threads, job.memorySize, job.engine) == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
-	if (scoreboard_cycle(&scoreboardCPU, argv[6]) == FAILURE) {
-		printf("[Fatal] Scoreboard algorithm cycles failed\n");
-		scoreboard_destroy(&scoreboardCPU, config, MEMORY_SIZE);
+	/* Check input arguments, A restored run takes only the output files since cfg and memin are in the checkpoint */
+	firstPath = (job.restorePath != NULL) ? MEMOUT_FILE_IDX : CFG_FILE_IDX;
+	if (!isValid || (argsNum != NUM_OF_SIM_FILES - firstPath) || (threads != 0)) {
+		print_usage();
 		return EXIT_FAILURE;
 	}
-	/* Save the output */
-	if (write_memout(argv[3], memory) == FAILURE) {
-		printf("[Fatal] Saving memout file failed\n");
-		scoreboard_destroy(&scoreboardCPU, config, MEMORY_SIZE);
-		return EXIT_FAILURE;
+	for (i=0; i<NUM_OF_SIM_FILES; ++i) {
+		job.paths[i] = (i < firstPath) ? NULL : args[i - firstPath];
 	}
-	if (write_regout(argv[4], scoreboardCPU.Register) == FAILURE) {
-		printf("[Fatal] Saving memout file failed\n");
-		scoreboard_destroy(&scoreboardCPU, config, MEMORY_SIZE);
+	job.line = 0;
+	if (batch_runJob(&job) == FAILURE) {
+		Message_Print("[Fatal] %s\n", job.error);
 		return EXIT_FAILURE;
 	}
-	if (write_traceinst(argv[5], &scoreboardCPU) == FAILURE) {
-		printf("[Fatal] Saving traceinst file failed\n");
-		scoreboard_destroy(&scoreboardCPU, config, MEMORY_SIZE);
-		return EXIT_FAILURE;
+	if (job.samplePeriod != 0) {
+		sample_printResult(&(job.sample));
 	}
-	/* Cleanup and exit gracefully */
-	scoreboard_destroy(&scoreboardCPU, config, instructionNum);
-	return EXIT_SUCCESS; 
+	return EXIT_SUCCESS;
 }
@@ -1,9 +1,13 @@
 #ifndef SIM_H_
 #define SIM_H_
 
+#include "batch.h"
 #include "defines.h"
 #include "input_output.h"
+#include "message.h"
+#include "sample.h"
 #include "scoreboard.h"
+#include "sweep.h"
 
 int main(int argc, char** argv);
 
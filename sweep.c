@@ -0,0 +1,329 @@
+#include <stddef.h>
+#include "sweep.h"
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Free everything the sweep allocated */
+void sweep_destroy(stSweep *);
+/* Find the index of the numeric configuration field 'name', return -1 if there is no such field */
+int sweep_findField(const char *);
+/* Fill 'config' with the configuration of point 'pointIdx' */
+void sweep_getPointConfiguration(stSweep *, unsigned int, configuration *);
+/* Load the sweep file 'path' into 'pSweep'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sweep_load(char *, stSweep *);
+/* Parse the values list 'spec' of the field 'fieldIdx' into 'pSweep'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sweep_parseValues(stSweep *, int, char *);
+/* Simulate the sweep point 'pointIdx', 'pContext' is the sweep */
+void sweep_runPoint(void *, unsigned int);
+/* Write the results of all the points to the CSV file 'path'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sweep_writeCSV(char *, stSweep *);
+
+/************************************************************************/
+/*	Private variables						*/
+/************************************************************************/
+/* The numeric configuration fields, in the order of the 'configuration' struct */
+static const char* fieldNames[NUM_OF_CONFIGURATION_NUMS] = CONFIGURATION_NUM_NAMES;
+static const size_t fieldOffsets[NUM_OF_CONFIGURATION_NUMS] = {
+	offsetof(configuration, add_nr_units), offsetof(configuration, sub_nr_units), offsetof(configuration, mul_nr_units),
+	offsetof(configuration, div_nr_units), offsetof(configuration, ld_nr_units), offsetof(configuration, st_nr_units),
+	offsetof(configuration, add_delay), offsetof(configuration, sub_delay), offsetof(configuration, mul_delay),
+	offsetof(configuration, div_delay), offsetof(configuration, ld_delay), offsetof(configuration, st_delay),
+	offsetof(configuration, fetch_width), offsetof(configuration, issue_width),
+	offsetof(configuration, add_pipeline_depth), offsetof(configuration, sub_pipeline_depth), offsetof(configuration, mul_pipeline_depth),
+	offsetof(configuration, div_pipeline_depth), offsetof(configuration, ld_pipeline_depth), offsetof(configuration, st_pipeline_depth),
+	offsetof(configuration, add_init_interval), offsetof(configuration, sub_init_interval), offsetof(configuration, mul_init_interval),
+	offsetof(configuration, div_init_interval), offsetof(configuration, ld_init_interval), offsetof(configuration, st_init_interval)
+};
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Simulate the program in 'meminPath' for every point of the sweep file 'sweepPath' on 'threads' workers
+ * (0 picks the number of online CPUs) and write the total cycles and FU utilization of every point to 'csvPath'
+ * Every point runs on its own copy of a 'memorySize' words memory with the 'engine' (ENGINE_SCOREBOARD or ENGINE_TOMASULO)
+ * The function return SUCCESS (true) if all the points succeeded and FAILURE (false) otherwise */
+bool sweep_run(char* sweepPath, char* meminPath, char* csvPath, int threads, uint32_t memorySize, int engine) {
+	stSweep sweep;
+	unsigned int failedPoints = 0, i = 0;
+	bool result = SUCCESS;
+	memset(&sweep, 0, sizeof(stSweep));
+	sweep.engine = engine;
+	if ((check_files_permission("sweep", sweepPath, CHECK_INPUT_FILE) == FAILURE) |
+	    (check_files_permission("memin", meminPath, CHECK_INPUT_FILE) == FAILURE) |
+	    (check_files_permission("csv", csvPath, CHECK_OUTPUT_FILE) == FAILURE)) {
+		return FAILURE;
+	}
+	if (sweep_load(sweepPath, &sweep) == FAILURE) {
+		Message_Print("[Fatal] Parsing sweep file failed\n");
+		sweep_destroy(&sweep);
+		return FAILURE;
+	}
+	/* Load and decode the program once, all the points share it */
+	sweep.pResults = (stSweepResult*) calloc(sweep.pointsNum, sizeof(stSweepResult));
+	if (!sweep.pResults) {
+		Message_Print("[Fatal] Sweep malloc failed\n");
+		sweep_destroy(&sweep);
+		return FAILURE;
+	}
+	if (Memory_Init(&(sweep.memory), memorySize) == FAILURE) {
+		sweep_destroy(&sweep);
+		return FAILURE;
+	}
+	if (load_memin(meminPath, &(sweep.memory)) == FAILURE) {
+		Message_Print("[Fatal] Parsing memin file failed\n");
+		sweep_destroy(&sweep);
+		return FAILURE;
+	}
+	if (decode_program(&(sweep.memory), &(sweep.pProgram), &(sweep.instructionNum)) == FAILURE) {
+		Message_Print("[Fatal] Decoding memin program failed\n");
+		sweep_destroy(&sweep);
+		return FAILURE;
+	}
+	batch_runParallel(sweep_runPoint, &sweep, sweep.pointsNum, threads);
+	for (i=0; i<sweep.pointsNum; ++i) {
+		if (sweep.pResults[i].error != NULL) {
+			failedPoints++;
+		}
+	}
+	if (sweep_writeCSV(csvPath, &sweep) == FAILURE) {
+		Message_Print("[Fatal] Saving csv file failed\n");
+		result = FAILURE;
+	}
+	printf("Sweep finished, %u of %u points succeeded\n", sweep.pointsNum - failedPoints, sweep.pointsNum);
+	sweep_destroy(&sweep);
+	return ((result == SUCCESS) && (failedPoints == 0)) ? SUCCESS : FAILURE;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Free everything the sweep allocated */
+void sweep_destroy(stSweep* pSweep) {
+	int i = 0;
+	for (i=0; i<NUM_OF_CONFIGURATION_NUMS; ++i) {
+		free(pSweep->pValues[i]);
+	}
+	Memory_Destroy(&(pSweep->memory));
+	free(pSweep->pProgram);
+	free(pSweep->pResults);
+}
+
+/* Find the index of the numeric configuration field 'name', return -1 if there is no such field */
+int sweep_findField(const char* name) {
+	int i = 0;
+	for (i=0; i<NUM_OF_CONFIGURATION_NUMS; ++i) {
+		if (strcmp(fieldNames[i], name) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* Fill 'config' with the configuration of point 'pointIdx' */
+void sweep_getPointConfiguration(stSweep* pSweep, unsigned int pointIdx, configuration* config) {
+	int i = 0;
+	memset(config, 0, sizeof(configuration)); /* An empty trace_unit, the points are not traced */
+	for (i=NUM_OF_CONFIGURATION_NUMS-1; 0<=i; --i) { /* The last field changes the fastest */
+		*(unsigned short int*)((char*)config + fieldOffsets[i]) = pSweep->pValues[i][pointIdx % pSweep->valuesNum[i]];
+		pointIdx = pointIdx / pSweep->valuesNum[i];
+	}
+}
+
+/* Load the sweep file 'path' into 'pSweep'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sweep_load(char* path, stSweep* pSweep) {
+	FILE* fp;
+	char* line = NULL;
+	char* src = NULL;
+	char* dst = NULL;
+	char* value = NULL;
+	char defaultValue[8] = {0};
+	size_t len = 0;
+	unsigned int line_count = 0;
+	unsigned long pointsNum = 1;
+	int fieldIdx = 0;
+	bool isValid = true;
+	fp = fopen(path, "r"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
+	if (fp == NULL) {
+		perror("fopen");
+		return FAILURE;
+	}
+	while (isValid && (getline(&line, &len, fp) != -1)) {
+		line_count++;
+		for (src=line, dst=line; *src != '\0'; ++src) { /* Remove all the white spaces */
+			if ((*src != ' ') && (*src != '\t') && (*src != '\r') && (*src != '\n')) {
+				*dst++ = *src;
+			}
+		}
+		*dst = '\0';
+		if ((line[0] == '\0') || (line[0] == '#')) { /* Skip empty lines and comments */
+			continue;
+		}
+		value = strchr(line, '=');
+		if (value == NULL) {
+			Message_Print("[Error] Sweep file line %u is not '<field> = <values>'\n", line_count);
+			isValid = false;
+			break;
+		}
+		*value++ = '\0';
+		if (strcmp(line, "trace_unit") == 0) { /* Allowed so a regular cfg file is a valid single point sweep */
+			continue;
+		}
+		fieldIdx = sweep_findField(line);
+		if (fieldIdx < 0) {
+			Message_Print("[Error] Sweep file line %u has an unknown field '%s'\n", line_count, line);
+			isValid = false;
+		} else if (pSweep->pValues[fieldIdx] != NULL) {
+			Message_Print("[Error] Sweep file line %u repeats the field '%s'\n", line_count, line);
+			isValid = false;
+		} else if (sweep_parseValues(pSweep, fieldIdx, value) == FAILURE) {
+			Message_Print("[Error] Sweep file line %u has invalid values for '%s'\n", line_count, line);
+			isValid = false;
+		}
+	}
+	if (line) {
+		free(line);
+	}
+	fclose(fp);
+	for (fieldIdx=0; isValid && (fieldIdx<NUM_OF_CONFIGURATION_NUMS); ++fieldIdx) {
+		if ((pSweep->pValues[fieldIdx] == NULL) && (NUM_OF_REQUIRED_CONFIGURATION_NUMS <= fieldIdx)) { /* An optional field keeps its cfg file default */
+			snprintf(defaultValue, sizeof(defaultValue), "%d", DEFAULT_OPTIONAL_CFG_VALUE);
+			isValid = sweep_parseValues(pSweep, fieldIdx, defaultValue);
+		}
+		if (!isValid) {
+			Message_Print("[Error] Sweep values malloc failed\n");
+		} else if (pSweep->pValues[fieldIdx] == NULL) {
+			Message_Print("[Error] Sweep file is missing the field '%s'\n", fieldNames[fieldIdx]);
+			isValid = false;
+		} else {
+			pointsNum = pointsNum * pSweep->valuesNum[fieldIdx];
+			if (MAX_SWEEP_POINTS < pointsNum) {
+				Message_Print("[Error] Sweep has more than %d points\n", MAX_SWEEP_POINTS);
+				isValid = false;
+			}
+		}
+	}
+	pSweep->pointsNum = (unsigned int)pointsNum;
+	return isValid ? SUCCESS : FAILURE;
+}
+
+/* Parse the values list 'spec' of the field 'fieldIdx' into 'pSweep'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sweep_parseValues(stSweep* pSweep, int fieldIdx, char* spec) {
+	unsigned short int* values = NULL;
+	unsigned short int* grown = NULL;
+	unsigned int valuesNum = 0, capacity = 0, first = 0, last = 0, step = 1, curr = 0;
+	char* item = NULL;
+	int consumed = 0, matched = 0;
+	for (item=strtok(spec, ","); item != NULL; item=strtok(NULL, ",")) {
+		step = 1;
+		consumed = 0;
+		matched = sscanf(item, "%u%n-%u%n:%u%n", &first, &consumed, &last, &consumed, &step, &consumed); /* 'first', 'first-last' or 'first-last:step' */
+		if (matched == 1) {
+			last = first;
+		}
+		if ((matched < 1) || (item[consumed] != '\0') || (last < first) || (step == 0) || (CONFIGURATION_INT_MAX_VALUE < last)) {
+			free(values);
+			return FAILURE;
+		}
+		for (curr=first; curr<=last; curr+=step) {
+			if (valuesNum == capacity) {
+				capacity = (capacity == 0) ? 16 : (capacity * 2);
+				grown = (unsigned short int*) realloc(values, sizeof(unsigned short int) * capacity);
+				if (!grown) {
+					free(values);
+					return FAILURE;
+				}
+				values = grown;
+			}
+			values[valuesNum++] = (unsigned short int)curr;
+		}
+	}
+	if (valuesNum == 0) {
+		free(values);
+		return FAILURE;
+	}
+	pSweep->pValues[fieldIdx] = values;
+	pSweep->valuesNum[fieldIdx] = valuesNum;
+	return SUCCESS;
+}
+
+/* Simulate the sweep point 'pointIdx', 'pContext' is the sweep */
+void sweep_runPoint(void* pContext, unsigned int pointIdx) {
+	stSweep* pSweep = (stSweep*) pContext;
+	stSweepResult* pResult = &(pSweep->pResults[pointIdx]);
+	stScoreboardCPU scoreboardCPU;
+	stMemory memory;
+	uint32_t busyCycles[NUM_OF_FU_TYPES] = {0};
+	unsigned int unitsNum = 0, i = 0;
+	int op = 0;
+	configuration* config = (configuration*) malloc(sizeof(configuration));
+	if (!config) {
+		pResult->error = "Configuration malloc failed";
+		return;
+	}
+	sweep_getPointConfiguration(pSweep, pointIdx, config);
+	if (Memory_Copy(&memory, &(pSweep->memory)) == FAILURE) { /* Stores of one point must not be seen by the others */
+		pResult->error = "Memory copy failed";
+		free(config);
+		return;
+	}
+	if (scoreboard_init(&scoreboardCPU, config, &memory, pSweep->pProgram, pSweep->instructionNum) == FAILURE) {
+		pResult->error = "Scoreboard initialization failed";
+	} else {
+		scoreboardCPU.engine = pSweep->engine;
+		if (scoreboard_cycle(&scoreboardCPU, NULL) == FAILURE) {
+			pResult->error = "Scoreboard algorithm cycles failed";
+		} else {
+			pResult->cycles = scoreboardCPU.cycle;
+			for (i=0; i<scoreboardCPU.numOfFUs; ++i) {
+				busyCycles[scoreboardCPU.pFUs[i].m_op] += scoreboardCPU.pFUs[i].busyCycles;
+			}
+			for (op=0; op<NUM_OF_FU_TYPES; ++op) {
+				unitsNum = scoreboardCPU.FUsNum[op];
+				pResult->utilization[op] = (unitsNum == 0) ? 0 : ((float)busyCycles[op] / ((float)unitsNum * pResult->cycles));
+			}
+		}
+	}
+	scoreboard_destroy(&scoreboardCPU, config);
+	Memory_Destroy(&memory);
+}
+
+/* Write the results of all the points to the CSV file 'path'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool sweep_writeCSV(char* path, stSweep* pSweep) {
+	FILE* fp;
+	configuration config;
+	unsigned int pointIdx = 0;
+	int i = 0;
+	fp = fopen(path, "w"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
+	if (fp == NULL) {
+		perror("fopen");
+		return FAILURE;
+	}
+	for (i=0; i<NUM_OF_CONFIGURATION_NUMS; ++i) {
+		fprintf(fp, "%s,", fieldNames[i]);
+	}
+	fprintf(fp, "total_cycles,ld_utilization,st_utilization,add_utilization,sub_utilization,mul_utilization,div_utilization,error\n");
+	for (pointIdx=0; pointIdx<pSweep->pointsNum; ++pointIdx) {
+		sweep_getPointConfiguration(pSweep, pointIdx, &config);
+		for (i=0; i<NUM_OF_CONFIGURATION_NUMS; ++i) {
+			fprintf(fp, "%hu,", *(unsigned short int*)((char*)&config + fieldOffsets[i]));
+		}
+		if (pSweep->pResults[pointIdx].error != NULL) {
+			fprintf(fp, ",,,,,,,%s\n", pSweep->pResults[pointIdx].error);
+			continue;
+		}
+		fprintf(fp, "%u", pSweep->pResults[pointIdx].cycles);
+		for (i=0; i<NUM_OF_FU_TYPES; ++i) {
+			fprintf(fp, ",%.4f", pSweep->pResults[pointIdx].utilization[i]);
+		}
+		fprintf(fp, ",\n");
+	}
+	fclose(fp);
+	return SUCCESS;
+}
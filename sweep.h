@@ -0,0 +1,19 @@
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include "batch.h"
+#include "defines.h"
+#include "input_output.h"
+#include "memory.h"
+#include "message.h"
+#include "scoreboard.h"
+
+/* Simulate the program in 'meminPath' for every point of the sweep file 'sweepPath' on 'threads' workers
+ * (0 picks the number of online CPUs) and write the total cycles and FU utilization of every point to 'csvPath'
+ * Every point runs on its own copy of a 'memorySize' words memory with the 'engine' (ENGINE_SCOREBOARD or ENGINE_TOMASULO)
+ * Every sweep file line is '<field> = <values>', where values is a comma separated list of numbers and
+ * 'first-last' or 'first-last:step' ranges, e.g. 'mul_delay = 2-10:2,20'
+ * The function return SUCCESS (true) if all the points succeeded and FAILURE (false) otherwise */
+bool sweep_run(char *, char *, char *, int, uint32_t, int);
+
+#endif /* SWEEP_H_ */
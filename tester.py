@@ -1,10 +1,20 @@
 #!/usr/bin/env python
 # -*- coding: utf-8 -*-
 import os
+import shutil
+import tempfile
 
-COMMAND = "./sim ./{tests_dir}/{test_dir}/cfg.txt ./{tests_dir}/{test_dir}/memin.txt ./{tests_dir}/{test_dir}/test_memout.txt ./{tests_dir}/{test_dir}/test_regout.txt ./{tests_dir}/{test_dir}/test_traceinst.txt ./{tests_dir}/{test_dir}/test_traceunit.txt"
+COMMAND = "./sim{flags} ./{tests_dir}/{test_dir}/cfg.txt ./{tests_dir}/{test_dir}/memin.txt ./{tests_dir}/{test_dir}/test_memout.txt ./{tests_dir}/{test_dir}/test_regout.txt ./{tests_dir}/{test_dir}/test_traceinst.txt ./{tests_dir}/{test_dir}/test_traceunit.txt"
 TESTS_DIR = "Test_Files"
 FILES = ["cfg.txt", "memin.txt", "memout.txt", "regout.txt", "traceinst.txt", "traceunit.txt"]
+# The options of the tests that check an optional feature of the simulator
+TEST_FLAGS = {"Test_8": ["--tomasulo"]}
+# Generated programs checked with --self-check against the timing free engine, With stores, WAR and WAW hazards
+WORKGEN_COMMAND = "./workgen --seed {seed} --length 400 {options} {dir}/memin.txt {dir}/cfg.txt"
+SELF_CHECK_COMMAND = "./sim --self-check {flags} {dir}/cfg.txt {dir}/memin.txt {dir}/memout.txt {dir}/regout.txt {dir}/traceinst.txt {dir}/traceunit.txt"
+SELF_CHECK_SEEDS = range(1, 9)
+SELF_CHECK_OPTIONS = ["--war 50", "--waw 50", "--war 30 --waw 30 --mix 2,3,3,2,1,1"]
+SELF_CHECK_FLAGS = ["", "--tomasulo"]
 
 class bcolors:
 	RED = '\033[91m'
@@ -32,6 +42,21 @@ def compare_files(file_1, file_2):
 			return False
 	return True
 
+def self_check():
+	work_dir = tempfile.mkdtemp()
+	failed = 0
+	for seed in SELF_CHECK_SEEDS:
+		for options in SELF_CHECK_OPTIONS:
+			os.system(WORKGEN_COMMAND.format(seed = seed, options = options, dir = work_dir))
+			for flags in SELF_CHECK_FLAGS:
+				loop_command = SELF_CHECK_COMMAND.format(flags = flags, dir = work_dir)
+				if os.system(loop_command) != 0:
+					color_print(bcolors.RED, "Self check of 'workgen --seed {} {}' failed: '{}'".format(seed, options, loop_command))
+					failed += 1
+	shutil.rmtree(work_dir)
+	if failed == 0:
+		color_print(bcolors.GREEN, "Self check of {} generated programs pass".format(len(SELF_CHECK_SEEDS) * len(SELF_CHECK_OPTIONS) * len(SELF_CHECK_FLAGS)))
+
 def main():
 	list_tests = os.listdir(TESTS_DIR)
 	list_tests.sort()
@@ -41,7 +66,7 @@ def main():
 			if filename in FILES:
 				counter += 1
 		if counter == len(FILES):
-			loop_command = COMMAND.format(tests_dir = TESTS_DIR, test_dir = test_dir)
+			loop_command = COMMAND.format(flags = "".join(" {}".format(flag) for flag in TEST_FLAGS.get(test_dir, [])), tests_dir = TESTS_DIR, test_dir = test_dir)
 			color_print(bcolors.BLUE, "Execute '{}'".format(loop_command))
 			os.system(loop_command)
 			found_error = False
@@ -59,4 +84,5 @@ def main():
 
 if __name__ == "__main__":
 	main()
+	self_check()
 
@@ -0,0 +1,438 @@
+#include "trace.h"
+
+/************************************************************************/
+/*	Private functions prototypes					*/
+/************************************************************************/
+/* Write the pending run of identical traceunit rows of the unit 'unitId' as one binary record */
+void Trace_FlushRun(stTraceFile *, uint16_t);
+/* Read a little endian number from 'pSrc' */
+uint16_t Trace_Get16(const unsigned char *);
+uint32_t Trace_Get32(const unsigned char *);
+/* Check if two traceunit rows hold the same unit state */
+bool Trace_IsSameRow(const stTraceRow *, const stTraceRow *);
+/* Write the text traceunit of the binary traceunit records 'pRecords', Every unit records are in cycle order but
+ * the units are interleaved, so the rows of all the units are merged back into cycle order
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Trace_MergeUnitRecords(stTraceFile *, const unsigned char *, unsigned int);
+/* Write a little endian number at 'pDst' and return the end of the written bytes */
+char* Trace_Put16(char *, uint16_t);
+char* Trace_Put32(char *, uint32_t);
+/* Read the whole file 'path' into a new buffer, The buffer must be freed by the caller
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Trace_ReadFile(char *, unsigned char **, size_t *);
+
+/************************************************************************/
+/*	Public functions declaration					*/
+/************************************************************************/
+/* Append the traceinst line (or binary record) of the instruction 'word' at 'pc' that ran on the FU 'fuId'
+ * 'stages' holds the issue, read operands, execute end and write result cycles */
+void Trace_AddInst(stTraceFile* pTrace, uint32_t word, uint32_t pc, uint16_t fuId, const uint32_t* stages) {
+	char* pLine = OutBuf_Reserve(pTrace->pOut);
+	int stage = 0;
+	if (pTrace->binary) { /* The PC is the record index, The issue cycle is a delta from the previous issue and the other stages are deltas from the issue */
+		pLine = Trace_Put32(pLine, word);
+		pLine = Trace_Put16(pLine, fuId);
+		pLine = Trace_Put32(pLine, stages[ISSUE_STAGE_IDX] - pTrace->lastCycle);
+		for (stage=READ_REGISTERS_STAGE_IDX; stage<=WRITE_RESULT_STAGE_IDX; ++stage) {
+			pLine = Trace_Put32(pLine, stages[stage] - stages[ISSUE_STAGE_IDX]);
+		}
+		pTrace->lastCycle = stages[ISSUE_STAGE_IDX];
+	} else { /* "<instruction> <pc> <unit> <issue> <read> <execute end> <write>" */
+		pLine = OutBuf_FormatHex8(pLine, word);
+		*pLine++ = ' ';
+		pLine = OutBuf_FormatUInt(pLine, pc);
+		*pLine++ = ' ';
+		if (fuId != BIN_TRACE_NO_FU) {
+			pLine = OutBuf_FormatString(pLine, pTrace->pFUNames + (size_t)fuId * MAX_LENGTH_OF_FU_NAME);
+		}
+		for (stage=ISSUE_STAGE_IDX; stage<=WRITE_RESULT_STAGE_IDX; ++stage) {
+			*pLine++ = ' ';
+			pLine = OutBuf_FormatInt(pLine, (int32_t)stages[stage]);
+		}
+		*pLine++ = '\n';
+	}
+	OutBuf_Commit(pTrace->pOut, pLine);
+}
+
+/* Append the traceunit rows of 'count' consecutive cycles starting at 'cycle', The traced units state in all of
+ * them is the 'rowsNum' rows of 'pRows' (in FU id order) */
+void Trace_AddUnitRows(stTraceFile* pTrace, uint32_t cycle, uint32_t count, const stTraceRow* pRows, unsigned int rowsNum) {
+	const stTraceRow* pRow = NULL;
+	stTraceRun* pRun = NULL;
+	char* pLine = NULL;
+	uint32_t i = 0;
+	unsigned int rowIdx = 0;
+	if (pTrace->binary) {
+		for (rowIdx=0; rowIdx<rowsNum; ++rowIdx) {
+			pRow = &(pRows[rowIdx]);
+			pRun = &(pTrace->pRuns[pRow->unitId]);
+			if ((pRun->length != 0) && (cycle == pRun->start + pRun->length) && Trace_IsSameRow(&(pRun->row), pRow)) {
+				pRun->length += count; /* Extend the pending run */
+			} else {
+				Trace_FlushRun(pTrace, pRow->unitId);
+				pRun->row = *pRow;
+				pRun->start = cycle;
+				pRun->length = count;
+			}
+		}
+		return;
+	}
+	for (i=0; i<count; ++i) { /* "<cycle> <unit> F<i> F<j> F<k> <Qj> <Qk> <Rj> <Rk>", One line for every unit in every cycle */
+		for (rowIdx=0; rowIdx<rowsNum; ++rowIdx) {
+			pRow = &(pRows[rowIdx]);
+			pLine = OutBuf_Reserve(pTrace->pOut);
+			pLine = OutBuf_FormatInt(pLine, (int32_t)(cycle + i));
+			*pLine++ = ' ';
+			pLine = OutBuf_FormatString(pLine, pTrace->pFUNames + (size_t)pRow->unitId * MAX_LENGTH_OF_FU_NAME);
+			pLine = OutBuf_FormatString(pLine, " F");
+			pLine = OutBuf_FormatUInt(pLine, pRow->Fi);
+			pLine = OutBuf_FormatString(pLine, " F");
+			pLine = OutBuf_FormatUInt(pLine, pRow->Fj);
+			pLine = OutBuf_FormatString(pLine, " F");
+			pLine = OutBuf_FormatUInt(pLine, pRow->Fk);
+			*pLine++ = ' ';
+			pLine = OutBuf_FormatString(pLine, (pRow->flags & BIN_TRACE_FLAG_QJ) ? pTrace->pFUNames + (size_t)pRow->Qj * MAX_LENGTH_OF_FU_NAME : "-");
+			*pLine++ = ' ';
+			pLine = OutBuf_FormatString(pLine, (pRow->flags & BIN_TRACE_FLAG_QK) ? pTrace->pFUNames + (size_t)pRow->Qk * MAX_LENGTH_OF_FU_NAME : "-");
+			pLine = OutBuf_FormatString(pLine, (pRow->flags & BIN_TRACE_FLAG_RJ) ? " Yes" : " No");
+			pLine = OutBuf_FormatString(pLine, (pRow->flags & BIN_TRACE_FLAG_RK) ? " Yes\n" : " No\n");
+			OutBuf_Commit(pTrace->pOut, pLine);
+		}
+	}
+}
+
+/* Flush the trace file and release its state, The output buffer itself is closed by the caller */
+void Trace_Close(stTraceFile* pTrace) {
+	unsigned int unitId = 0;
+	for (unitId=0; (pTrace->pRuns != NULL) && (unitId<pTrace->fuNum); ++unitId) {
+		Trace_FlushRun(pTrace, (uint16_t)unitId);
+	}
+	free(pTrace->pRuns);
+	pTrace->pRuns = NULL;
+	free(pTrace->pFUNames);
+	pTrace->pFUNames = NULL;
+}
+
+/* Regenerate the text traceunit or traceinst file 'textPath' from the binary trace file 'binaryPath'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Trace_ConvertToText(char* binaryPath, char* textPath) {
+	stOutBuffer out;
+	stTraceFile text;
+	unsigned char* pData = NULL;
+	unsigned char* pRecord = NULL;
+	size_t length = 0, recordLength = 0;
+	unsigned int fuCounts[NUM_OF_FU_TYPES] = {0};
+	unsigned int fuDepths[NUM_OF_FU_TYPES] = {0};
+	unsigned int pc = 0;
+	uint32_t cycle = 0, stages[WRITE_RESULT_STAGE_IDX + 1] = {0};
+	bool isUnitTrace = false, isValid = true;
+	int op = 0, stage = 0;
+	if (Trace_ReadFile(binaryPath, &pData, &length) == FAILURE) {
+		return FAILURE;
+	}
+	if ((length < BIN_TRACE_HEADER_LENGTH) || (Trace_Get16(pData + 4) != BIN_TRACE_VERSION) ||
+	    ((memcmp(pData, BIN_TRACE_UNIT_MAGIC, 4) != 0) && (memcmp(pData, BIN_TRACE_INST_MAGIC, 4) != 0))) {
+		Message_Print("[Error] '%s' is not a version %d binary trace\n", binaryPath, BIN_TRACE_VERSION);
+		free(pData);
+		return FAILURE;
+	}
+	isUnitTrace = (memcmp(pData, BIN_TRACE_UNIT_MAGIC, 4) == 0);
+	recordLength = isUnitTrace ? BIN_TRACE_UNIT_RECORD_LENGTH : BIN_TRACE_INST_RECORD_LENGTH;
+	if ((length - BIN_TRACE_HEADER_LENGTH) % recordLength != 0) {
+		Message_Print("[Error] '%s' is truncated\n", binaryPath);
+		free(pData);
+		return FAILURE;
+	}
+	for (op=0; op<NUM_OF_FU_TYPES; ++op) {
+		fuCounts[op] = Trace_Get16(pData + 6 + 2 * op);
+		fuDepths[op] = Trace_Get16(pData + 6 + 2 * (NUM_OF_FU_TYPES + op));
+		if ((fuDepths[op] == 0) || (MAX_PIPELINE_DEPTH < fuDepths[op]) || (fuCounts[op] % fuDepths[op] != 0)) {
+			isValid = false;
+		}
+	}
+	if (!isValid) {
+		Message_Print("[Error] '%s' has an invalid pipeline depth\n", binaryPath);
+		free(pData);
+		return FAILURE;
+	}
+	if (OutBuf_Open(&out, textPath) == FAILURE) {
+		perror("open");
+		free(pData);
+		return FAILURE;
+	}
+	if (Trace_Open(&text, &out, false, (const char*)pData, fuCounts, fuDepths) == FAILURE) {
+		OutBuf_Close(&out);
+		free(pData);
+		return FAILURE;
+	}
+	if (isUnitTrace) {
+		isValid = Trace_MergeUnitRecords(&text, pData + BIN_TRACE_HEADER_LENGTH, (unsigned int)((length - BIN_TRACE_HEADER_LENGTH) / recordLength));
+	}
+	for (pRecord=pData+BIN_TRACE_HEADER_LENGTH; !isUnitTrace && isValid && (pRecord<pData+length); pRecord+=recordLength, ++pc) {
+		stages[ISSUE_STAGE_IDX] = cycle + Trace_Get32(pRecord + 6);
+		for (stage=READ_REGISTERS_STAGE_IDX; stage<=WRITE_RESULT_STAGE_IDX; ++stage) {
+			stages[stage] = stages[ISSUE_STAGE_IDX] + Trace_Get32(pRecord + 6 + 4 * stage);
+		}
+		cycle = stages[ISSUE_STAGE_IDX];
+		isValid = (Trace_Get16(pRecord + 4) < text.fuNum) || (Trace_Get16(pRecord + 4) == BIN_TRACE_NO_FU);
+		if (isValid) {
+			Trace_AddInst(&text, Trace_Get32(pRecord), pc, Trace_Get16(pRecord + 4), stages);
+		} else {
+			Message_Print("[Error] '%s' record %u refers to an unknown FU\n", binaryPath, pc);
+		}
+	}
+	free(pData);
+	Trace_Close(&text);
+	return (OutBuf_Close(&out) == SUCCESS) && isValid;
+}
+
+/* Write the name of the FU 'idx' of the type 'op' to 'pName', "<type><unit>" or "<type><unit>.<slot>" for a unit
+ * deeper than one slot, 'count' is the number of FUs of the type and 'depth' the slots of every unit
+ * The end of the name is returned */
+char* Trace_FormatFUName(char* pName, int op, unsigned int idx, unsigned int count, unsigned int depth) {
+	const char* typeNames[NUM_OF_FU_TYPES] = FU_TYPE_NAMES;
+	pName = OutBuf_FormatUInt(OutBuf_FormatString(pName, typeNames[op]), idx % (count / depth));
+	if (1 < depth) {
+		*pName++ = '.';
+		pName = OutBuf_FormatUInt(pName, idx / (count / depth));
+	}
+	*pName = '\0';
+	return pName;
+}
+
+/* Start a trace in the text or the binary format on the open output 'pOut', 'magic' is BIN_TRACE_UNIT_MAGIC or
+ * BIN_TRACE_INST_MAGIC, or NULL to continue a trace that already has its header (a restored checkpoint)
+ * 'fuCounts' holds the number of FUs of every type and 'fuDepths' the pipeline depth of every type
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Trace_Open(stTraceFile* pTrace, stOutBuffer* pOut, bool binary, const char* magic, const unsigned int* fuCounts, const unsigned int* fuDepths) {
+	char* pHeader = NULL;
+	char* pName = NULL;
+	unsigned int op = 0, i = 0;
+	pTrace->pOut = pOut;
+	pTrace->binary = binary;
+	pTrace->lastCycle = 0;
+	pTrace->fuNum = 0;
+	pTrace->pFUNames = NULL;
+	pTrace->pRuns = NULL;
+	for (op=0; op<NUM_OF_FU_TYPES; ++op) {
+		pTrace->fuCounts[op] = (uint16_t)fuCounts[op];
+		pTrace->fuDepths[op] = (uint16_t)fuDepths[op];
+		pTrace->fuNum += fuCounts[op];
+	}
+	if (binary) {
+		pTrace->pRuns = (stTraceRun*) calloc(pTrace->fuNum + 1, sizeof(stTraceRun));
+		if (!pTrace->pRuns) {
+			Message_Print("[Error] Trace runs malloc failed\n");
+			return FAILURE;
+		}
+	} else { /* The text format refers to the FUs by name, "<type><unit>" or "<type><unit>.<slot>" */
+		pTrace->pFUNames = (char*) calloc(pTrace->fuNum + 1, MAX_LENGTH_OF_FU_NAME);
+		if (!pTrace->pFUNames) {
+			Message_Print("[Error] FU names malloc failed\n");
+			return FAILURE;
+		}
+		pName = pTrace->pFUNames;
+		for (op=0; op<NUM_OF_FU_TYPES; ++op) {
+			for (i=0; i<fuCounts[op]; ++i) {
+				Trace_FormatFUName(pName, (int)op, i, fuCounts[op], fuDepths[op]);
+				pName += MAX_LENGTH_OF_FU_NAME;
+			}
+		}
+	}
+	if (binary && (magic != NULL)) {
+		pHeader = OutBuf_Reserve(pTrace->pOut);
+		memcpy(pHeader, magic, 4);
+		pHeader = Trace_Put16(pHeader + 4, BIN_TRACE_VERSION);
+		for (op=0; op<NUM_OF_FU_TYPES; ++op) {
+			pHeader = Trace_Put16(pHeader, pTrace->fuCounts[op]);
+		}
+		for (op=0; op<NUM_OF_FU_TYPES; ++op) {
+			pHeader = Trace_Put16(pHeader, pTrace->fuDepths[op]);
+		}
+		OutBuf_Commit(pTrace->pOut, pHeader);
+	}
+	return SUCCESS;
+}
+
+/************************************************************************/
+/*	Private functions declaration					*/
+/************************************************************************/
+/* Write the pending run of identical traceunit rows of the unit 'unitId' as one binary record */
+void Trace_FlushRun(stTraceFile* pTrace, uint16_t unitId) {
+	stTraceRun* pRun = &(pTrace->pRuns[unitId]);
+	char* pRecord = NULL;
+	if (pRun->length == 0) {
+		return;
+	}
+	pRecord = OutBuf_Reserve(pTrace->pOut);
+	pRecord = Trace_Put32(pRecord, pRun->start - pRun->lastCycle);
+	pRecord = Trace_Put32(pRecord, pRun->length);
+	pRecord = Trace_Put16(pRecord, pRun->row.unitId);
+	*pRecord++ = (char)pRun->row.Fi;
+	*pRecord++ = (char)pRun->row.Fj;
+	*pRecord++ = (char)pRun->row.Fk;
+	*pRecord++ = (char)pRun->row.flags;
+	pRecord = Trace_Put16(pRecord, pRun->row.Qj);
+	pRecord = Trace_Put16(pRecord, pRun->row.Qk);
+	OutBuf_Commit(pTrace->pOut, pRecord);
+	pRun->lastCycle = pRun->start + pRun->length - 1;
+	pRun->length = 0;
+}
+
+/* Read a little endian number from 'pSrc' */
+uint16_t Trace_Get16(const unsigned char* pSrc) {
+	return (uint16_t)(pSrc[0] | (pSrc[1] << 8));
+}
+
+uint32_t Trace_Get32(const unsigned char* pSrc) {
+	return (uint32_t)pSrc[0] | ((uint32_t)pSrc[1] << 8) | ((uint32_t)pSrc[2] << 16) | ((uint32_t)pSrc[3] << 24);
+}
+
+/* Check if two traceunit rows hold the same unit state */
+bool Trace_IsSameRow(const stTraceRow* pRow, const stTraceRow* pOther) {
+	return (pRow->unitId == pOther->unitId) && (pRow->Fi == pOther->Fi) && (pRow->Fj == pOther->Fj) && (pRow->Fk == pOther->Fk) &&
+	       (pRow->flags == pOther->flags) && (pRow->Qj == pOther->Qj) && (pRow->Qk == pOther->Qk);
+}
+
+/* Write the text traceunit of the binary traceunit records 'pRecords', Every unit records are in cycle order but
+ * the units are interleaved, so the rows of all the units are merged back into cycle order
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Trace_MergeUnitRecords(stTraceFile* pText, const unsigned char* pRecords, unsigned int recordsNum) {
+	stTraceRun* pRuns = (stTraceRun*) calloc(recordsNum + 1, sizeof(stTraceRun));
+	unsigned int* pUnitFirst = (unsigned int*) calloc(pText->fuNum + 1, sizeof(unsigned int)); /* Index in pRuns of the first run of every unit */
+	unsigned int* pUnitNext = (unsigned int*) calloc(pText->fuNum + 1, sizeof(unsigned int)); /* Index in pRuns of the current run of every unit */
+	uint32_t* pLastCycle = (uint32_t*) calloc(pText->fuNum + 1, sizeof(uint32_t));
+	stTraceRow* pRows = (stTraceRow*) calloc(pText->fuNum + 1, sizeof(stTraceRow));
+	unsigned int* pUnits = (unsigned int*) calloc(pText->fuNum + 1, sizeof(unsigned int)); /* The units that have runs, in FU id order */
+	const unsigned char* pRecord = NULL;
+	stTraceRow row;
+	unsigned int i = 0, unitId = 0, unitsNum = 0, rowsNum = 0;
+	uint32_t cycle = 0, nextCycle = 0;
+	bool isValid = (pRuns && pUnitFirst && pUnitNext && pLastCycle && pRows && pUnits);
+	if (!isValid) {
+		Message_Print("[Error] Trace merge malloc failed\n");
+	}
+	for (i=0; isValid && (i<recordsNum); ++i) { /* Count the runs of every unit */
+		unitId = Trace_Get16(pRecords + (size_t)i * BIN_TRACE_UNIT_RECORD_LENGTH + 8);
+		if (pText->fuNum <= unitId) {
+			Message_Print("[Error] Binary trace record %u refers to an unknown FU\n", i);
+			isValid = false;
+		} else {
+			pUnitFirst[unitId + 1]++;
+		}
+	}
+	for (unitId=0; isValid && (unitId<pText->fuNum); ++unitId) {
+		if (pUnitFirst[unitId + 1] != 0) {
+			pUnits[unitsNum++] = unitId;
+		}
+		pUnitFirst[unitId + 1] += pUnitFirst[unitId];
+		pUnitNext[unitId] = pUnitFirst[unitId];
+	}
+	for (i=0; isValid && (i<recordsNum); ++i) { /* Group the runs by unit, keeping their order */
+		pRecord = pRecords + (size_t)i * BIN_TRACE_UNIT_RECORD_LENGTH;
+		row.unitId = Trace_Get16(pRecord + 8);
+		row.Fi = pRecord[10];
+		row.Fj = pRecord[11];
+		row.Fk = pRecord[12];
+		row.flags = pRecord[13];
+		row.Qj = Trace_Get16(pRecord + 14);
+		row.Qk = Trace_Get16(pRecord + 16);
+		if (((row.flags & BIN_TRACE_FLAG_QJ) && (pText->fuNum <= row.Qj)) || ((row.flags & BIN_TRACE_FLAG_QK) && (pText->fuNum <= row.Qk)) || (Trace_Get32(pRecord + 4) == 0)) {
+			Message_Print("[Error] Binary trace record %u is invalid\n", i);
+			isValid = false;
+			break;
+		}
+		pRuns[pUnitNext[row.unitId]].row = row;
+		pRuns[pUnitNext[row.unitId]].start = pLastCycle[row.unitId] + Trace_Get32(pRecord);
+		pRuns[pUnitNext[row.unitId]].length = Trace_Get32(pRecord + 4);
+		pLastCycle[row.unitId] = pRuns[pUnitNext[row.unitId]].start + pRuns[pUnitNext[row.unitId]].length - 1;
+		pUnitNext[row.unitId]++;
+	}
+	for (unitId=0; isValid && (unitId<pText->fuNum); ++unitId) {
+		pUnitNext[unitId] = pUnitFirst[unitId];
+		pLastCycle[unitId] = 0; /* Now the number of rows of the current run that were written */
+	}
+	while (isValid) { /* Write the earliest pending cycle, with the rows of all the units that are traced in it */
+		rowsNum = 0;
+		for (i=0; i<unitsNum; ++i) {
+			unitId = pUnits[i];
+			if (pUnitNext[unitId] == pUnitFirst[unitId + 1]) { /* No runs left */
+				continue;
+			}
+			cycle = pRuns[pUnitNext[unitId]].start + pLastCycle[unitId];
+			if ((rowsNum == 0) || (cycle < nextCycle)) {
+				nextCycle = cycle;
+				rowsNum = 0;
+			}
+			if (cycle == nextCycle) {
+				pRows[rowsNum++] = pRuns[pUnitNext[unitId]].row;
+			}
+		}
+		if (rowsNum == 0) {
+			break;
+		}
+		Trace_AddUnitRows(pText, nextCycle, 1, pRows, rowsNum);
+		for (i=0; i<rowsNum; ++i) {
+			unitId = pRows[i].unitId;
+			if (++pLastCycle[unitId] == pRuns[pUnitNext[unitId]].length) {
+				pUnitNext[unitId]++;
+				pLastCycle[unitId] = 0;
+			}
+		}
+	}
+	free(pRuns);
+	free(pUnitFirst);
+	free(pUnitNext);
+	free(pLastCycle);
+	free(pRows);
+	free(pUnits);
+	return isValid;
+}
+
+/* Write a little endian number at 'pDst' and return the end of the written bytes */
+char* Trace_Put16(char* pDst, uint16_t value) {
+	pDst[0] = (char)(value & 0xFF);
+	pDst[1] = (char)(value >> 8);
+	return pDst + 2;
+}
+
+char* Trace_Put32(char* pDst, uint32_t value) {
+	pDst[0] = (char)(value & 0xFF);
+	pDst[1] = (char)((value >> 8) & 0xFF);
+	pDst[2] = (char)((value >> 16) & 0xFF);
+	pDst[3] = (char)(value >> 24);
+	return pDst + 4;
+}
+
+/* Read the whole file 'path' into a new buffer, The buffer must be freed by the caller
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Trace_ReadFile(char* path, unsigned char** ppData, size_t* pLength) {
+	FILE* fp;
+	long length = 0;
+	fp = fopen(path, "rb"); /* Upon successful completion fopen() return a FILE pointer. Otherwise, NULL is returned and errno is set to indicate the error. */
+	if (fp == NULL) {
+		perror("fopen");
+		return FAILURE;
+	}
+	if ((fseek(fp, 0, SEEK_END) != 0) || ((length = ftell(fp)) < 0) || (fseek(fp, 0, SEEK_SET) != 0)) {
+		perror("fseek");
+		fclose(fp);
+		return FAILURE;
+	}
+	*ppData = (unsigned char*) malloc((size_t)length + 1);
+	if (!*ppData) {
+		Message_Print("[Error] Trace malloc failed\n");
+		fclose(fp);
+		return FAILURE;
+	}
+	if (fread(*ppData, 1, (size_t)length, fp) != (size_t)length) {
+		perror("fread");
+		free(*ppData);
+		*ppData = NULL;
+		fclose(fp);
+		return FAILURE;
+	}
+	*pLength = (size_t)length;
+	fclose(fp);
+	return SUCCESS;
+}
@@ -0,0 +1,29 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "defines.h"
+#include "message.h"
+#include "out_buffer.h"
+
+/* Append the traceinst line (or binary record) of the instruction 'word' at 'pc' that ran on the FU 'fuId'
+ * 'stages' holds the issue, read operands, execute end and write result cycles */
+void Trace_AddInst(stTraceFile *, uint32_t, uint32_t, uint16_t, const uint32_t *);
+/* Append the traceunit rows of 'count' consecutive cycles starting at 'cycle', The traced units state in all of
+ * them is the 'rowsNum' rows of 'pRows' (in FU id order) */
+void Trace_AddUnitRows(stTraceFile *, uint32_t, uint32_t, const stTraceRow *, unsigned int);
+/* Flush the trace file and release its state, The output buffer itself is closed by the caller */
+void Trace_Close(stTraceFile *);
+/* Regenerate the text traceunit or traceinst file 'textPath' from the binary trace file 'binaryPath'
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Trace_ConvertToText(char *, char *);
+/* Write the name of the FU 'idx' of the type 'op' to 'pName', "<type><unit>" or "<type><unit>.<slot>" for a unit
+ * deeper than one slot, 'count' is the number of FUs of the type and 'depth' the slots of every unit
+ * The end of the name is returned */
+char* Trace_FormatFUName(char *, int, unsigned int, unsigned int, unsigned int);
+/* Start a trace in the text or the binary format on the open output 'pOut', 'magic' is BIN_TRACE_UNIT_MAGIC or
+ * BIN_TRACE_INST_MAGIC, or NULL to continue a trace that already has its header (a restored checkpoint)
+ * 'fuCounts' holds the number of FUs of every type and 'fuDepths' the pipeline depth of every type
+ * The function return SUCCESS (true) on sucess and FAILURE (false) otherwise */
+bool Trace_Open(stTraceFile *, stOutBuffer *, bool, const char *, const unsigned int *, const unsigned int *);
+
+#endif /* TRACE_H_ */